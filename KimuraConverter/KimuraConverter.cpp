@@ -9,6 +9,7 @@
 #include "Threadpool.h"
 #include <filesystem>
 #include <type_traits>
+#include <zlib.h>
 
 #include "Include/IKimuraConverter.h"
 
@@ -322,6 +323,10 @@ void Converter::DoWorkFromMainWorkThread()
 
 		std::printf("Writing table of content to output file...\n");
 		this->WriteTableOfContent();
+		if (this->Error)
+		{
+			return;
+		}
 
 		// for each saved frame, append its data to the frame and update the TOC
 
@@ -400,6 +405,8 @@ void Converter::PrintHelp()
 	std::printf("   flip: Flip order of triangle indices. Default is 'false'.\n");
 	std::printf("   flipUV: Flip texture coordinates along V. Default is 'true'.\n");
 	std::printf("   cpu: Number of threads used for processing frames. By default, this is automatically set to the number of cores available. \n");
+	std::printf("   compressTOC: Compress the frame tables of the table of content with zlib. Players must be built with zlib to read them. Default is 'false'.\n");
+	std::printf("   tocPageSize: Approximate size in KB of the pages the frame tables are split in. The player only keeps the pages around the frames it buffers. Default is 256.\n");
 
 	
 	std::printf("   image[index]: Path to a file image, or the first file image of a sequence.\n");
@@ -620,149 +627,276 @@ uint32 Converter::Write(std::vector<byte>& d)
 }
 
 
+template<typename T>
+void Converter::Append(std::vector<byte>& InOutBlock, const T& In, uint32 InCount /*=1*/)
+{
+	size_t position = InOutBlock.size();
+	InOutBlock.resize(position + sizeof(T) * InCount);
+	memcpy(&InOutBlock[position], &In, sizeof(T) * InCount);
+}
+
+void Converter::Append(std::vector<byte>& InOutBlock, const std::string& s)
+{
+	int size = (int)s.length();
+	this->Append<int>(InOutBlock, size);
+	if (size > 0)
+	{
+		InOutBlock.insert(InOutBlock.end(), s.begin(), s.end());
+	}
+}
+
+
 //-----------------------------------------------------------------------------
 // Converter::WriteTableOfContent
 //-----------------------------------------------------------------------------
 void Converter::WriteTableOfContent()
 {
+	// The player reads the metadata and page directory in a single read, then the pages it needs. See the layout in Player.h
+	std::vector<byte> metadata;
 
-	this->Write<Version>(this->TOC.Version_);
-	this->Write(this->TOC.SourceFile);
-	this->Write(this->TOC.CreationDate);
+	this->Append(metadata, this->TOC.SourceFile);
+	this->Append(metadata, this->TOC.CreationDate);
 
-	this->Write<float>(this->TOC.TimePerFrame);
-	this->Write<float>(this->TOC.FrameRate);
+	this->Append<float>(metadata, this->TOC.TimePerFrame);
+	this->Append<float>(metadata, this->TOC.FrameRate);
 
 	uint32 b16BitIndices = this->Options.Force16bitIndices ? 1 : 0;
-	this->Write<uint32>(b16BitIndices);
+	this->Append<uint32>(metadata, b16BitIndices);
 
 	// meshes
 	{
 		uint32 numMeshes = (uint32)this->TOC.Meshes.size();
-		this->Write<uint32>(numMeshes);
+		this->Append<uint32>(metadata, numMeshes);
 
 		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
 		{
 			TOCMesh& m = this->TOC.Meshes[iMesh];
 
-			this->Write(m.Name);
+			this->Append(metadata, m.Name);
 
-			this->Write<bool>(m.Constant);
-			this->Write<uint64>(m.MaxVertices);
-			this->Write<uint64>(m.MaxSurfaces);
-			this->Write<PositionFormat>(m.PositionFormat_);
-			this->Write<NormalFormat>(m.NormalFormat_);
-			this->Write<TangentFormat>(m.TangentFormat_);
-			this->Write<VelocityFormat>(m.VelocityFormat_);
-			this->Write<TexCoordFormat>(m.TexCoordFormat_);
-			this->Write<ColorFormat>(m.ColorFormat_);
+			this->Append<bool>(metadata, m.Constant);
+			this->Append<uint64>(metadata, m.MaxVertices);
+			this->Append<uint64>(metadata, m.MaxSurfaces);
+			this->Append<PositionFormat>(metadata, m.PositionFormat_);
+			this->Append<NormalFormat>(metadata, m.NormalFormat_);
+			this->Append<TangentFormat>(metadata, m.TangentFormat_);
+			this->Append<VelocityFormat>(metadata, m.VelocityFormat_);
+			this->Append<TexCoordFormat>(metadata, m.TexCoordFormat_);
+			this->Append<ColorFormat>(metadata, m.ColorFormat_);
 		}
 	}
 
 	// image sequences
 	{
 		uint32 numImageSequences = (uint32)this->TOC.ImageSequences.size();
-		this->Write<uint32>(numImageSequences);
+		this->Append<uint32>(metadata, numImageSequences);
 		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
 		{
 			TOCImageSequence& IS = this->TOC.ImageSequences[iIS];
 
-			this->Write(IS.Name);
-			this->Write<ImageFormat>(IS.Format);
+			this->Append(metadata, IS.Name);
+			this->Append<ImageFormat>(metadata, IS.Format);
 
-			this->Write<bool>(IS.Constant);
-			this->Write<uint32>(IS.Width);
-			this->Write<uint32>(IS.Height);
-			this->Write<uint32>(IS.MipMapCount);
+			this->Append<bool>(metadata, IS.Constant);
+			this->Append<uint32>(metadata, IS.Width);
+			this->Append<uint32>(metadata, IS.Height);
+			this->Append<uint32>(metadata, IS.MipMapCount);
 
 		}
 
 	}
 
-	// frames
+	uint32 numFrames = (uint32) this->TOC.Frames.size();
+	uint32 numMeshes = (uint32) this->TOC.Meshes.size();
+	uint32 numImageSequences = (uint32) this->TOC.ImageSequences.size();
+
+	// the frames each frame depends on are resolved once here, the player reads them from the frame records
+	TOCFrameTable frameTable;
 	{
-		uint32 numFrames = (uint32) this->TOC.Frames.size();
-		this->Write<uint32>(numFrames);
+		frameTable.Initialize(this->TOC);
 
 		for (uint32 iFrame = 0; iFrame < numFrames; iFrame++)
 		{
 			TOCFrame& f = this->TOC.Frames[iFrame];
 
-			this->Write<uint64>(f.FilePosition);
-			this->Write<uint64>(f.BufferSize);
+			frameTable.AddFrame(f.FilePosition, f.BufferSize);
 
-			for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
+			for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
 			{
 				TOCFrameMesh& fm = f.Meshes[iMesh];
+				frameTable.AddFrameMesh(iMesh, fm, fm.Sections.data(), (uint32)fm.Sections.size());
+			}
+
+			for (const TOCFrameImage& fi : f.Images)
+			{
+				frameTable.AddFrameImage(fi);
+			}
+		}
 
-				this->Write<uint32>(fm.Vertices);
-				this->Write<uint32>(fm.Surfaces);
+		frameTable.Finalize();
+		frameTable.ResolveFrameDependencies(this->TOC);
+	}
 
-				uint32 numSections = (uint32)fm.Sections.size();
-				this->Write<uint32>(numSections);
-				for (TOCFrameMeshSection& s : fm.Sections)
-				{
-					this->Write<uint32>(s.VertexStart);
-					this->Write<uint32>(s.IndexStart);
-					this->Write<uint32>(s.NumSurfaces);
-					this->Write<uint32>(s.MinVertexIndex);
-					this->Write<uint32>(s.MaxVertexIndex);
-				}
+	// split the frames in pages of about TOCPageSize bytes
+	uint32 framesPerPage = 1;
+	if (numFrames > 0)
+	{
+		uint64 totalSize = (uint64)numFrames * (sizeof(TOCFrameRecord) + numMeshes * sizeof(TOCFrameMeshRecord) + numImageSequences * sizeof(TOCFrameImage)) +
+							(uint64)frameTable.Sections.size() * sizeof(TOCFrameMeshSection);
+		uint64 bytesPerFrame = totalSize / numFrames;
 
-				this->Write<int32>(fm.SeekIndices);
-				this->Write<uint32>(fm.SizeIndices);
+		framesPerPage = (uint32)std::min<uint64>(std::max<uint64>(this->Options.TOCPageSize / bytesPerFrame, 1), numFrames);
+	}
 
-				this->Write<int32>(fm.SeekPositions);
-				this->Write<uint32>(fm.SizePositions);
-				this->Write<Kimura::Vector3>(fm.PositionQuantizationCenter);
-				this->Write<Kimura::Vector3>(fm.PositionQuantizationExtents);
+	this->Append<uint32>(metadata, numFrames);
+	this->Append<uint32>(metadata, framesPerPage);
 
-				this->Write<int32>(fm.SeekNormals);
-				this->Write<uint32>(fm.SizeNormals);
+	// frame tables, one page after the other. Each page holds fixed-stride tables for its own frames
+	std::vector<byte> frameTables;
+	std::vector<TOCPageRecord> pageDirectory;
+	uint32 flags = TOCFlags_None;
+
+	if (this->Options.CompressTableOfContent)
+	{
+		flags |= TOCFlags_CompressedFrameTables;
+	}
+
+	for (uint32 firstFrame = 0; firstFrame < numFrames; firstFrame += framesPerPage)
+	{
+		uint32 lastFrame = std::min(firstFrame + framesPerPage, numFrames);
 
-				this->Write<int32>(fm.SeekTangents);
-				this->Write<uint32>(fm.SizeTangents);
+		std::vector<byte> page;
 
-				this->Write<int32>(fm.SeekVelocities);
-				this->Write<uint32>(fm.SizeVelocities);
-				this->Write<Kimura::Vector3>(fm.VelocityQuantizationCenter);
-				this->Write<Kimura::Vector3>(fm.VelocityQuantizationExtents);
+		for (uint32 iFrame = firstFrame; iFrame < lastFrame; iFrame++)
+		{
+			TOCFrame& f = this->TOC.Frames[iFrame];
 
-				this->Write<int32>(fm.SeekTexCoords[0], MaxTextureCoords);
-				this->Write<uint32>(fm.SizeTexCoords[0], MaxTextureCoords);
+			TOCFrameRecord frameRecord;
+			frameRecord.FilePosition = f.FilePosition;
+			frameRecord.BufferSize = f.BufferSize;
+			frameRecord.FrameIndexDependency = frameTable.GetFrameIndexDependency(iFrame);
 
-				this->Write<int32>(fm.SeekColors[0], MaxColorChannels);
-				this->Write<uint32>(fm.SizeColors[0], MaxColorChannels);
-				this->Write<Kimura::Vector4>(fm.ColorQuantizationExtents[0], MaxColorChannels);
+			this->Append<TOCFrameRecord>(page, frameRecord);
+		}
 
-				this->Write<Kimura::Vector3>(fm.BoundingCenter);
-				this->Write<Kimura::Vector3>(fm.BoundingSize);
+		// sections are numbered from the start of the page
+		std::vector<TOCFrameMeshSection> sections;
 
-			}
+		for (uint32 iFrame = firstFrame; iFrame < lastFrame; iFrame++)
+		{
+			TOCFrame& f = this->TOC.Frames[iFrame];
 
-			for (uint32 iIS = 0; iIS  < this->TOC.ImageSequences.size(); iIS++)
+			for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
 			{
-				TOCFrameImage& fi = f.Images[iIS];
+				TOCFrameMesh& fm = f.Meshes[iMesh];
 
-				this->Write<uint32>(fi.NumMipmaps);
-				for (uint32 iMipmap = 0; iMipmap < MaxMipmaps; iMipmap++)
-				{
-					this->Write<uint32>(fi.Mipmaps[iMipmap].Width);
-					this->Write<uint32>(fi.Mipmaps[iMipmap].Height);
-					this->Write<uint32>(fi.Mipmaps[iMipmap].RowPitch);
-					this->Write<uint32>(fi.Mipmaps[iMipmap].SlicePitch);
+				TOCFrameMeshRecord meshRecord;
+
+				meshRecord.Vertices = fm.Vertices;
+				meshRecord.Surfaces = fm.Surfaces;
+
+				meshRecord.FirstSection = (uint32)sections.size();
+				meshRecord.NumSections = (uint32)fm.Sections.size();
+				sections.insert(sections.end(), fm.Sections.begin(), fm.Sections.end());
 
-					this->Write<int32>(fi.Mipmaps[iMipmap].SeekPosition);
-					this->Write<uint32>(fi.Mipmaps[iMipmap].Size);
+				meshRecord.SeekIndices = fm.SeekIndices;
+				meshRecord.SizeIndices = fm.SizeIndices;
 
+				meshRecord.SeekPositions = fm.SeekPositions;
+				meshRecord.SizePositions = fm.SizePositions;
+				meshRecord.PositionQuantizationCenter = fm.PositionQuantizationCenter;
+				meshRecord.PositionQuantizationExtents = fm.PositionQuantizationExtents;
+
+				meshRecord.SeekNormals = fm.SeekNormals;
+				meshRecord.SizeNormals = fm.SizeNormals;
+
+				meshRecord.SeekTangents = fm.SeekTangents;
+				meshRecord.SizeTangents = fm.SizeTangents;
+
+				meshRecord.SeekVelocities = fm.SeekVelocities;
+				meshRecord.SizeVelocities = fm.SizeVelocities;
+				meshRecord.VelocityQuantizationCenter = fm.VelocityQuantizationCenter;
+				meshRecord.VelocityQuantizationExtents = fm.VelocityQuantizationExtents;
+
+				for (uint32 iTexCoord = 0; iTexCoord < MaxTextureCoords; iTexCoord++)
+				{
+					meshRecord.SeekTexCoords[iTexCoord] = fm.SeekTexCoords[iTexCoord];
+					meshRecord.SizeTexCoords[iTexCoord] = fm.SizeTexCoords[iTexCoord];
 				}
 
+				for (uint32 iColor = 0; iColor < MaxColorChannels; iColor++)
+				{
+					meshRecord.SeekColors[iColor] = fm.SeekColors[iColor];
+					meshRecord.SizeColors[iColor] = fm.SizeColors[iColor];
+					meshRecord.ColorQuantizationExtents[iColor] = fm.ColorQuantizationExtents[iColor];
+				}
+
+				meshRecord.BoundingCenter = fm.BoundingCenter;
+				meshRecord.BoundingSize = fm.BoundingSize;
+
+				this->Append<TOCFrameMeshRecord>(page, meshRecord);
 			}
+		}
+
+		if (!sections.empty())
+		{
+			this->Append<TOCFrameMeshSection>(page, sections[0], (uint32)sections.size());
+		}
+
+		for (uint32 iFrame = firstFrame; iFrame < lastFrame; iFrame++)
+		{
+			TOCFrame& f = this->TOC.Frames[iFrame];
 
+			if (!f.Images.empty())
+			{
+				this->Append<TOCFrameImage>(page, f.Images[0], numImageSequences);
+			}
 		}
 
+		TOCPageRecord pageRecord;
+		pageRecord.Offset = frameTables.size();
+		pageRecord.UncompressedSize = (uint32)page.size();
+		pageRecord.NumSections = (uint32)sections.size();
+
+		if (this->Options.CompressTableOfContent)
+		{
+			uLongf compressedSize = compressBound((uLong)page.size());
+			std::vector<byte> compressedPage(compressedSize);
+
+			if (compress2(compressedPage.data(), &compressedSize, page.data(), (uLong)page.size(), Z_BEST_COMPRESSION) != Z_OK)
+			{
+				this->FatalError("Failed to compress the table of content");
+				return;
+			}
+
+			compressedPage.resize(compressedSize);
+			page.swap(compressedPage);
+		}
+
+		pageRecord.Size = (uint32)page.size();
+		pageDirectory.push_back(pageRecord);
+
+		frameTables.insert(frameTables.end(), page.begin(), page.end());
 	}
 
+	// header
+	uint64 metadataSize = metadata.size();
+	uint64 pageDirectorySize = pageDirectory.size() * sizeof(TOCPageRecord);
+	uint64 frameTablesSize = frameTables.size();
+
+	this->Write<Version>(this->TOC.Version_);
+	this->Write<uint32>(flags);
+	this->Write<uint64>(metadataSize);
+	this->Write<uint64>(pageDirectorySize);
+	this->Write<uint64>(frameTablesSize);
+
+	this->Write(metadata);
+	if (!pageDirectory.empty())
+	{
+		this->Write<TOCPageRecord>(pageDirectory[0], (uint32)pageDirectory.size());
+	}
+	this->Write(frameTables);
+
 }
 
 
@@ -3534,6 +3668,8 @@ bool ConverterOptions::Parse(std::vector<std::string>& InArgs)
 			std::string preset = TryParseArgument(argument, "preset:");
 			std::string savePreset = TryParseArgument(argument, "bind:");
 			std::string cpu = TryParseArgument(argument, "cpu:");
+			std::string compressTOC = TryParseArgument(argument, "compressTOC:");
+			std::string tocPageSize = TryParseArgument(argument, "tocPageSize:");
 
 			// image sequence options
 			for (int i = 0; i < MaxImageSequences; i++)
@@ -3773,6 +3909,22 @@ bool ConverterOptions::Parse(std::vector<std::string>& InArgs)
 				}
 
 			}
+			else if (!compressTOC.empty())
+			{
+				this->CompressTableOfContent = compressTOC == "true";
+			}
+			else if (!tocPageSize.empty())
+			{
+				int sizeInKB = stoi(tocPageSize);
+
+				if (sizeInKB <= 0)
+				{
+					std::printf("Invalid argument for 'tocPageSize'\n");
+					return false;
+				}
+
+				this->TOCPageSize = (uint64)sizeInKB * 1024;
+			}
 			else if (!preset.empty())
 			{
 				if (preset == "ue4")
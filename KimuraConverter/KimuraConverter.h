@@ -170,6 +170,9 @@ namespace Kimura
 
 			int					NumThreadUsedForProcessingFrames = -1;
 
+			bool				CompressTableOfContent = false;
+			uint64				TOCPageSize = 256 * 1024;
+
 			bool				Verbose = true;
 
 			static const int		MaxImageSequences = 16;
@@ -476,6 +479,10 @@ namespace Kimura
 			uint32 Write(std::string& s);
 			uint32 Write(std::vector<byte>& d);
 
+			template<typename T>
+			void Append(std::vector<byte>& InOutBlock, const T& In, uint32 InCount = 1);
+			void Append(std::vector<byte>& InOutBlock, const std::string& s);
+
 			inline void RaiseWarning(Warnings w)
 			{
 				if (!this->RaisedWarnings[(int)w])
@@ -10,6 +10,8 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <functional>
+#include <future>
 
 namespace Kimura
 {
@@ -187,6 +189,63 @@ namespace Kimura
 		None
 	};
 
+	// vertex attributes of the meshes, for PlayerOptions::AttributesToLoad
+	enum MeshAttributeFlags : uint32
+	{
+		MeshAttributeFlags_Indices		= 1 << 0,
+		MeshAttributeFlags_Positions	= 1 << 1,
+		MeshAttributeFlags_Normals		= 1 << 2,
+		MeshAttributeFlags_Tangents		= 1 << 3,
+		MeshAttributeFlags_Velocities	= 1 << 4,
+		MeshAttributeFlags_TexCoords0	= 1 << 5,
+		MeshAttributeFlags_TexCoords1	= 1 << 6,
+		MeshAttributeFlags_TexCoords2	= 1 << 7,
+		MeshAttributeFlags_TexCoords3	= 1 << 8,
+		MeshAttributeFlags_Colors0		= 1 << 9,
+		MeshAttributeFlags_Colors1		= 1 << 10,
+		MeshAttributeFlags_All			= 0xffffffff
+	};
+
+	// order the frames are buffered in, for PlayerOptions::Direction
+	enum class PlaybackDirection : int
+	{
+		Forward,
+		Reverse,		// from the last frame to the first
+		PingPong		// forward then back, the first and last frames played once per cycle
+	};
+
+	// how the player ended up reading its frames given its options and the platform, for PlayerStats::ReadMethod
+	enum class FrameReadMethod : int
+	{
+		Regular,		// one at a time, from the player's thread
+		Threads,		// PlayerOptions::NumReaderThreads, or a thread for PlayerOptions::RawPreBufferingSize
+		IoUring,		// PlayerOptions::AsyncReadQueueDepth
+		External,		// PlayerOptions::ExternalReadQueueDepth
+		Mapped			// PlayerOptions::MemoryMappedFile, a source already in memory, or the mapping of a clip
+	};
+
+	// how the extra latency of the reads of a throttled source is spread, for ThrottleSettings::Jitter
+	enum class JitterDistribution : int
+	{
+		Uniform,		// between 0 and twice the mean
+		Exponential		// mostly short, with a long tail
+	};
+
+	// slow storage simulated for tests, such as a hard drive or a network share (PlayerOptions::Throttle, 
+	// CreateThrottledSource). The latency, jitter and stalls depend on the seed and on the position read only: the same 
+	// playback sees the same delays from one run to the next. The bandwidth is shared by the reads in the order their 
+	// latency ends, which depends on thread timing when several reads are in flight.
+	struct ThrottleSettings
+	{
+		uint64	BytesPerSecond = 0;					// shared by all the reads of the source, 0 for no limit
+		float	LatencyMS = 0.0f;					// per read
+		float	JitterMS = 0.0f;					// mean latency added per read
+		JitterDistribution	Jitter = JitterDistribution::Uniform;
+		float	StallProbability = 0.0f;			// odds for a read to stall for StallMS more, such as a NAS hiccup
+		float	StallMS = 0.0f;
+		uint32	Seed = 1;
+	};
+
 	class IFrame
 	{
 		public:
@@ -232,6 +291,8 @@ namespace Kimura
 
 			virtual void				GetBounds(uint32 InMeshIndex, Vector3& OutCenter, Vector3& OutSize) = 0;
 
+			// fails for the mipmaps not loaded (PlayerOptions::MinimumImageMipmaps) and, with PlayerOptions::LowPriorityImages,
+			// until the frame's images are read
 			virtual bool				GetImageData(uint32 InImageIndex, uint32 InMipmap, const void** OutData, uint32& OutSize) = 0;
 
 	};
@@ -286,12 +347,23 @@ namespace Kimura
 	{
 		uint32 BufferedFramesStart = 0;
 		uint32 BufferedFramesCount = 0;
+		uint32 PreBufferingSize = 0;				// as sized by PlayerOptions::AdaptivePreBuffering
+		FrameReadMethod ReadMethod = FrameReadMethod::Regular;
 
 		uint64 BytesReadInLastSecond = 0;
 		uint64 MemoryUsageForFrames = 0;
+		uint64 MemoryUsageForPinnedFrames = 0;		// not part of MemoryUsageForFrames
+		uint64 MemoryUsageForRetainedFrames = 0;	// frames no longer buffered, kept alive by the buffered frames reusing their data
+		uint64 MemoryUsageForRawFrames = 0;			// read ahead, not resolved yet (PlayerOptions::RawPreBufferingSize)
+		uint32 RawFramesCount = 0;
+		uint64 MemoryUsageForTableOfContent = 0;
 
 		uint32 NumFramesProcessedInLastSecond = 0;
 
+		// GetFrameAt and RequestFrame calls not finding a frame the player was pre-buffering: playback outran loading.
+		// Jumps elsewhere in the playback don't count. Since the player was created.
+		uint32 NumStalls = 0;
+
 		double AvgTimeSpentOnReadingFromDiskPerFrame = 0.0;
 		double TotalTimeSpentOnReadingFromDiskInLastSecond = 0.0;
 
@@ -300,6 +372,17 @@ namespace Kimura
 
 	};
 
+	// a frame read handed over to the host (PlayerOptions::ExternalReadQueueDepth)
+	struct ExternalRead
+	{
+		uint64	Id = 0;						// handed back to IPlayer::CompleteExternalRead
+		uint32	FrameIndex = 0;
+
+		uint64	FilePosition = 0;			// Size bytes starting there in the file are to be read into Destination
+		uint64	Size = 0;
+		void*	Destination = nullptr;		// owned by the player, valid until the read is completed
+	};
+
 
 	class IPlayer
 	{
@@ -316,7 +399,45 @@ namespace Kimura
 			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, bool InForceWait) = 0;
 			virtual std::shared_ptr<IFrame>	GetConstantFrame() = 0;
 
+			// the frame buffered last, without waiting nor affecting which frames get buffered. Never blocks.
+			virtual std::shared_ptr<IFrame>	GetLatestFrame() = 0;
+
+			// steers buffering towards the frame like GetFrameAt, without waiting for it. The callback is called once, from any 
+			// thread (possibly this one), as soon as the frame is buffered. The frame is null when it won't be: out of range,
+			// playback requested elsewhere in the meantime, or player destroyed. Any number of requests can be outstanding.
+			// Requests made while the player is initializing are kept until its table of content is read.
+			virtual void	RequestFrame(uint32 iFrame, std::function<void(std::shared_ptr<IFrame>)> InCallback) = 0;
+			virtual std::future<std::shared_ptr<IFrame>>	RequestFrame(uint32 iFrame) = 0;
+
 			virtual uint32	GetNumFrames() = 0;
+
+			// PlayerOptions::ManualPump only: does the player's pending work (reading the table of content, then reading and
+			// resolving the next frames to buffer) a frame at a time on the calling thread, until the budget is spent. At least
+			// one frame is done per call. Returns whether work was left when the budget ran out. Returns true right away if 
+			// another thread is already pumping the player.
+			virtual bool	Pump(double InTimeBudgetInMS) = 0;
+
+			// PlayerOptions::ExternalReadQueueDepth only: hands over the frame reads the player wants done, in playback order,
+			// and forgets about them. Every read taken has to be completed, before the player is released.
+			virtual void	TakeExternalReads(std::vector<ExternalRead>& OutReads) = 0;
+
+			// the destination of the read has been filled (or the read failed, which fails the player). The frame is 
+			// resolved and buffered on the calling thread.
+			virtual void	CompleteExternalRead(uint64 InReadId, bool InSucceeded) = 0;
+
+			// changes PlayerOptions::MeshesToLoad and PlayerOptions::AttributesToLoad. The frames buffered so far are 
+			// dropped and buffered again around the last frame requested.
+			virtual void	SetDataToLoad(const std::vector<bool>& InMeshes, uint32 InAttributes) = 0;
+
+			// changes PlayerOptions::MinimumImageMipmaps for one image sequence. Applies to the frames read from then on,
+			// the frames buffered so far keep their mipmaps.
+			virtual void	SetMinimumImageMipmap(uint32 InImageSequence, uint32 InMipmap) = 0;
+
+			// pinned frames stay in memory once loaded, wherever playback is, and are taken from there when playback gets 
+			// to them. They're loaded ahead of time whenever the player has nothing else to do. Frames past the end of 
+			// the playback are ignored.
+			virtual void	PinFrames(uint32 InFirstFrame, uint32 InNumFrames) = 0;
+			virtual void	UnpinFrames(uint32 InFirstFrame, uint32 InNumFrames) = 0;
 			
 			virtual bool	IsForcing16BitIndices() = 0;
 
@@ -324,6 +445,34 @@ namespace Kimura
 
 	};
 
+	// lets an engine route the memory holding frame data into its own memory system. Can be called from any thread.
+	class IFrameAllocator
+	{
+		public:
+
+			virtual ~IFrameAllocator() {}
+
+			virtual void*	Allocate(uint64 InSize, uint64 InAlignment) = 0;
+			virtual void	Free(void* InData, uint64 InSize) = 0;
+	};
+
+	// where a player reads the bytes of a file from: a file on disk, memory, part of a pack file, or anything else the
+	// engine provides. Reads can come from several threads at once.
+	class IByteSource
+	{
+		public:
+
+			virtual ~IByteSource() {}
+
+			virtual uint64	GetSize() = 0;
+
+			// reads exactly InSize bytes starting at InPosition, fails otherwise
+			virtual bool	ReadAt(uint64 InPosition, void* OutData, uint64 InSize) = 0;
+
+			// all of the bytes, when they're in memory already, for frames to point into rather than copy them
+			virtual const void*	GetData() { return nullptr; }
+	};
+
 	class PlayerOptions
 	{
 		public:
@@ -331,12 +480,170 @@ namespace Kimura
 			uint32 PreBufferingSize = 20;
 			uint32 BackBufferSize = 10;
 
+			// sizes PreBufferingSize as playback goes, from the read and processing times measured so far and the size 
+			// of the frames to come: enough frames are buffered ahead for loading to keep up with playback over the next
+			// PreBufferingLookAhead seconds, plus PreBufferingMargin seconds to spare, growing ahead of heavy frames. 
+			// Never more than PreBufferingMemory bytes of frames ahead. PreBufferingSize is used until the first frames
+			// are loaded.
+			bool AdaptivePreBuffering = false;
+			float PreBufferingLookAhead = 10.0f;
+			float PreBufferingMargin = 0.25f;
+			uint64 PreBufferingMemory = 256 * 1024 * 1024;
+
+			// frames read past the PreBufferingSize frames buffered ahead. They're kept as read from the file and only
+			// resolved once playback gets within PreBufferingSize frames of them, which takes far less than buffering
+			// them, to ride out slow reads (e.g. from shared network storage). Without reader threads (NumReaderThreads), 
+			// frames are read by a thread of their own. Ignored with BufferEntirePlayback.
+			uint32 RawPreBufferingSize = 0;
+
 			bool BufferEntirePlayback = false;
 
 			bool Loop = true;
 
+			// frames are buffered ahead in this order, RequestFrame and GetFrameAt are expected to follow it. Frames of
+			// files encoded with dependencies on previous frames are read along with those dependencies when played in 
+			// reverse, which are kept and buffered from memory as playback gets to them rather than read again. Without
+			// looping, ping-pong playback ends back on the first frame.
+			PlaybackDirection Direction = PlaybackDirection::Forward;
+
+			// when looping, the first PreBufferingSize frames played are pinned (IPlayer::PinFrames), playback wraps around
+			// to frames already in memory. The pin is released while the process is short of memory (SetFrameMemoryBudget)
+			// and restored once usage is back under the budget.
+			bool PinLoopHead = true;
+
+			// map the entire file in memory and have the frames point directly into the mapping rather than 
+			// reading each frame into its own buffer. Falls back to regular reads if the file can't be mapped.
+			// Players created on a byte source map nothing, they point into the source when it's in memory.
+			bool MemoryMappedFile = false;
+
+			// the file is read in blocks that are also written to this directory on local disk, and read from there from
+			// then on, by this player and the players after it (e.g. on the next loop, or the next run). For files on slow 
+			// shared storage. Files are known by their path, size and modification time. Past CacheSize bytes, the 
+			// blocks used least recently are deleted. The file isn't mapped. Empty for no cache.
+			std::string CacheDirectory;
+			uint64 CacheSize = (uint64)4 * 1024 * 1024 * 1024;
+
+			// the file is read as if from slower storage, for tests. When left as is, taken from the KIMURA_THROTTLE 
+			// environment variable if set, e.g. "bandwidth=50000000,latency=8,jitter=4,distribution=exponential,
+			// stall=0.01:250,seed=7" (bytes per second, milliseconds). Reads from the cache aren't throttled. The file 
+			// isn't mapped.
+			ThrottleSettings Throttle;
+
+			// number of threads reading frames in parallel, with positional reads through the player's byte source.
+			// Also the maximum number of reads in flight. 0 reads frames one at a time from the player's thread.
+			uint32 NumReaderThreads = 0;
+
+			// Linux only: number of reads kept in flight through io_uring, completed by a single thread. When io_uring
+			// isn't available, the player falls back to the reader threads (if any) or to its regular reads.
+			uint32 AsyncReadQueueDepth = 0;
+
+			// frame buffers are recycled by the player as frames leave the buffered window. The allocator is only 
+			// called when no recycled buffer fits. Leave empty to have the player allocate them itself.
+			std::shared_ptr<IFrameAllocator> FrameAllocator;
+
+			// back frame buffers of 2 MB and more with huge pages when the platform allows it. Ignored with a FrameAllocator.
+			bool HugePageFrameBuffers = false;
+
+			// no thread of its own, the player is served by a few threads shared with the other players created with this
+			// option. Frames are buffered first for the player about to run out of buffered frames, given its last 
+			// requested frame and the file's frame rate. 
+			bool SharedScheduler = false;
+
+			// players of the shared scheduler with a higher priority are always served first
+			int32 SchedulerPriority = 0;
+
+			// over SetFrameMemoryBudget, the players with the lowest priority give up their frames buffered ahead first
+			int32 MemoryPriority = 0;
+
+			// no thread at all, the host calls IPlayer::Pump from its own threads (e.g. once per tick from its job system) to
+			// have frames buffered. Takes precedence over SharedScheduler. Reader threads are still used when requested.
+			// Waiting in GetFrameAt from the only thread pumping the player never returns.
+			bool ManualPump = false;
+
+			// frame data isn't read by the player but by the host, through IPlayer::TakeExternalReads and 
+			// IPlayer::CompleteExternalRead. At most this many reads are handed over at any time. The player still 
+			// reads the table of content itself, as well as the first frame of files with a constant image sequence. 
+			// The file isn't mapped.
+			uint32 ExternalReadQueueDepth = 0;
+
+			// only the data of these meshes (by index, empty for all of them, meshes past the end aren't loaded) and of 
+			// these attributes (MeshAttributeFlags) is read. Images are always read. The frames still describe every mesh
+			// (vertices, sections, bounds) but return no data for the rest.
+			// Frames pointing into a memory mapping only page in the data needed, the asynchronous and external reads
+			// read the span of the frame covering it.
+			std::vector<bool> MeshesToLoad;
+			uint32 AttributesToLoad = MeshAttributeFlags_All;
+
+			// per image sequence (by index), the first mipmap read. The larger mipmaps aren't loaded, the smallest one 
+			// always is.
+			std::vector<uint32> MinimumImageMipmaps;
+
+			// image data is left out of the frames' reads and read once the frames to buffer have their meshes, whenever
+			// the player has nothing else to do. Frames are handed out before their images are in, frames dropped from 
+			// the buffered frames by then never get them. Only applies to the frames read by the player itself (regular 
+			// reads and reader threads) from a file that isn't mapped.
+			bool LowPriorityImages = false;
+
+	};
+
+	// one clip played by many instances at once, each at its own time offset. The clip reads the table of content once
+	// and hands out a cursor per instance. Cursors share the frames they have in common rather than reading and 
+	// holding their own copy, memory and reads then grow with the distinct frames in flight, not with the instances.
+	class IClip
+	{
+		public:
+
+			virtual PlayerStatus GetStatus() = 0;
+			virtual void GetFailStatusMessage(std::string& OutMessage) = 0;
+
+			virtual bool RetrievePlaybackInformation(PlaybackInformation& OutInfo) = 0;
+
+			// a player of its own for one instance, buffering around its own position with the clip's options
+			virtual std::shared_ptr<IPlayer> CreateCursor() = 0;
+
 	};
 
 	std::shared_ptr<IPlayer>	CreatePlayer(const std::string& InPath, const PlayerOptions& InOptions);
+	std::shared_ptr<IPlayer>	CreatePlayer(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
+
+	// the table of content is read right away, on the calling thread. Check the clip's status before creating cursors.
+	std::shared_ptr<IClip>		OpenClip(const std::string& InPath, const PlayerOptions& InOptions);
+	std::shared_ptr<IClip>		OpenClip(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
+
+	// a file on disk, opened once and read with positional reads. Null if the file can't be opened.
+	std::shared_ptr<IByteSource>	OpenFileSource(const std::string& InPath);
+
+	// bytes already in memory, not copied. InOwner is kept alive along with the source, and frames pointing into it.
+	std::shared_ptr<IByteSource>	CreateMemorySource(const void* InData, uint64 InSize, std::shared_ptr<const void> InOwner = nullptr);
+
+	// InSize bytes of another source, starting at InOffset. For clips stored in a pack file, opened once and shared
+	// by the sources of all of its clips. Null if the range doesn't fit in the source.
+	std::shared_ptr<IByteSource>	CreateSubRangeSource(std::shared_ptr<IByteSource> InSource, uint64 InOffset, uint64 InSize);
+
+	// another source read through a cache directory on local disk (see PlayerOptions::CacheDirectory). InKey identifies
+	// the bytes of the source, such as the path and modification time of a file, for later processes to find them. 
+	// Null if the directory can't be created.
+	std::shared_ptr<IByteSource>	CreateCachedSource(std::shared_ptr<IByteSource> InSource, const std::string& InKey, 
+										const std::string& InCacheDirectory, uint64 InCacheSize);
+
+	// another source read with the delays of slower storage, for tests
+	std::shared_ptr<IByteSource>	CreateThrottledSource(std::shared_ptr<IByteSource> InSource, const ThrottleSettings& InSettings);
+
+	// number of threads serving the players created with PlayerOptions::SharedScheduler, 2 by default. Can only grow.
+	void						SetSharedSchedulerThreads(uint32 InNumThreads);
+
+	// caps the frame buffers of all players together, 0 (the default) for no limit. Over budget, players stop buffering
+	// past the frame played next and drop the frames left behind playback, then the players with the lowest 
+	// PlayerOptions::MemoryPriority give up half of the frames they buffered ahead. Frames pinned through 
+	// IPlayer::PinFrames and frames held by the user are kept.
+	void						SetFrameMemoryBudget(uint64 InBytes);
+
+	// frame buffers of all players, including those of the frames only kept alive by the user or by the frames reusing
+	// their data, and those kept for reuse
+	uint64						GetFrameMemoryUsage();
+
+	// reads only the metadata at the start of the file, without creating a player or its loading thread
+	bool						ProbeFile(const std::string& InPath, PlaybackInformation& OutInfo);
+	bool						ProbeSource(std::shared_ptr<IByteSource> InSource, PlaybackInformation& OutInfo);
 
 }
\ No newline at end of file
@@ -11,20 +11,61 @@
 
 	// files
 	#include "GenericPlatform/GenericPlatformFile.h"
+	#include "Async/MappedFileHandle.h"
 	#include "Misc/Paths.h"
 
+	// memory
+	#include "HAL/UnrealMemory.h"
+
 #elif defined(KIMURA_WINDOWS)
 
 	#include <io.h>
  	#include <fcntl.h>
 
+	// keeps windows.h from defining min and max macros over std::min and std::max
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+	#include <malloc.h>
+
 #else
 
-	// default, use fstream. Already included in player.h
-	#include <fstream>
+	// memory mapped files
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+
+	// disk cache
+	#include <dirent.h>
+	#include <climits>
+
+	// frame buffers
+	#include <cstdlib>
 
+	#if defined(KIMURA_IO_URING)
+		#include <linux/io_uring.h>
+		#include <sys/syscall.h>
+		#include <cstring>
+	#endif
+
+#endif
+
+#if defined(KIMURA_ZLIB)
+	#include <zlib.h>
 #endif
 
+// disk cache, throttled sources
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
 const Kimura::Vector2 Kimura::Vector2::ZeroVector(0.0f, 0.0f);
 const Kimura::Vector3 Kimura::Vector3::ZeroVector(0.0f, 0.0f, 0.0f);
 const Kimura::Vector4 Kimura::Vector4::ZeroVector(0.0f, 0.0f, 0.0f, 0.0f);
@@ -42,6 +83,161 @@ std::shared_ptr<Kimura::IPlayer>	Kimura::CreatePlayer(const std::string& InPath,
 }
 
 
+//-----------------------------------------------------------------------------
+// Kimura::CreatePlayer
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IPlayer>	Kimura::CreatePlayer(std::shared_ptr<IByteSource> InSource, const Kimura::PlayerOptions& InOptions)
+{
+	return std::make_shared<Player>(InSource, InOptions);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::OpenClip
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IClip> Kimura::OpenClip(const std::string& InPath, const Kimura::PlayerOptions& InOptions)
+{
+	std::shared_ptr<Clip> clip = std::make_shared<Clip>(InPath, InOptions);
+	clip->Open();
+
+	return clip;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::OpenClip
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IClip> Kimura::OpenClip(std::shared_ptr<IByteSource> InSource, const Kimura::PlayerOptions& InOptions)
+{
+	std::shared_ptr<Clip> clip = std::make_shared<Clip>(InSource, InOptions);
+	clip->Open();
+
+	return clip;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::OpenFileSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::OpenFileSource(const std::string& InPath)
+{
+	std::shared_ptr<FileByteSource> source = std::make_shared<FileByteSource>();
+	if (!source->Open(InPath))
+	{
+		return nullptr;
+	}
+
+	return source;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateMemorySource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateMemorySource(const void* InData, uint64 InSize, std::shared_ptr<const void> InOwner)
+{
+	return std::make_shared<MemoryByteSource>(InData, InSize, InOwner);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateSubRangeSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateSubRangeSource(std::shared_ptr<IByteSource> InSource, uint64 InOffset, uint64 InSize)
+{
+	if (InSource == nullptr || InOffset > InSource->GetSize() || InSize > InSource->GetSize() - InOffset)
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<SubRangeByteSource>(InSource, InOffset, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateCachedSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateCachedSource(std::shared_ptr<IByteSource> InSource, const std::string& InKey, 
+	const std::string& InCacheDirectory, uint64 InCacheSize)
+{
+	if (InSource == nullptr)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<DiskCache> cache = DiskCache::Get(InCacheDirectory, InCacheSize);
+	if (cache == nullptr)
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<CachedByteSource>(InSource, cache, InKey);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateThrottledSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateThrottledSource(std::shared_ptr<IByteSource> InSource, const ThrottleSettings& InSettings)
+{
+	if (InSource == nullptr)
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<ThrottledByteSource>(InSource, InSettings);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::SetSharedSchedulerThreads
+//-----------------------------------------------------------------------------
+void Kimura::SetSharedSchedulerThreads(uint32 InNumThreads)
+{
+	Scheduler::Get().SetNumThreads(InNumThreads);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::SetFrameMemoryBudget
+//-----------------------------------------------------------------------------
+void Kimura::SetFrameMemoryBudget(uint64 InBytes)
+{
+	MemoryBudget::Get().SetLimit(InBytes);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::GetFrameMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::GetFrameMemoryUsage()
+{
+	return MemoryBudget::Get().GetUsage();
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::ProbeFile
+//-----------------------------------------------------------------------------
+bool Kimura::ProbeFile(const std::string& InPath, PlaybackInformation& OutInfo)
+{
+	Player player(InPath);
+
+	return player.Probe(OutInfo);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::ProbeSource
+//-----------------------------------------------------------------------------
+bool Kimura::ProbeSource(std::shared_ptr<IByteSource> InSource, PlaybackInformation& OutInfo)
+{
+	Player player(InSource);
+
+	return player.Probe(OutInfo);
+}
+
+
 //-----------------------------------------------------------------------------
 // Kimura::GetVersion
 //-----------------------------------------------------------------------------
@@ -59,7 +255,120 @@ Kimura::Player::Player(const std::string& InPath, const Kimura::PlayerOptions& I
 {
 	this->InputFilePath = InPath;
 
-	this->Thread = new std::thread([this](){this->ThreadExecute();});
+	this->Pool = std::make_shared<FramePool>(InOptions);
+
+	this->StartLoading();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Player
+//-----------------------------------------------------------------------------
+Kimura::Player::Player(const std::string& InPath)
+{
+	// probing only, no loader thread
+	this->InputFilePath = InPath;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Player
+//-----------------------------------------------------------------------------
+Kimura::Player::Player(std::shared_ptr<IByteSource> InSource, const Kimura::PlayerOptions& InOptions)
+	:
+	Options(InOptions)
+{
+	this->DataSource = InSource;
+
+	this->Pool = std::make_shared<FramePool>(InOptions);
+
+	this->StartLoading();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Player
+//-----------------------------------------------------------------------------
+Kimura::Player::Player(std::shared_ptr<IByteSource> InSource)
+{
+	// probing only, no loader thread
+	this->DataSource = InSource;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Player
+//-----------------------------------------------------------------------------
+Kimura::Player::Player(std::shared_ptr<Clip> InClip)
+	:
+	Options(InClip->Options)
+{
+	// cursor of a clip, the table of content, the pool and the frames are shared with the other cursors
+	this->InputFilePath = InClip->Source.InputFilePath;
+	this->DataSource = InClip->Source.DataSource;
+	this->DataSourceWrapsFile = InClip->Source.DataSourceWrapsFile;
+	this->Clip_ = InClip;
+
+	this->Pool = InClip->Pool;
+
+	this->StartLoading();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::StartLoading
+//-----------------------------------------------------------------------------
+void Kimura::Player::StartLoading()
+{
+	MemoryBudget::Get().Register(this);
+
+	this->Selection = FrameDataSelection::Create(this->Options.MeshesToLoad, this->Options.AttributesToLoad, 
+		this->Options.MinimumImageMipmaps, this->Options.LowPriorityImages);
+
+	if (this->Options.ExternalReadQueueDepth > 0)
+	{
+		this->ExternalReader = new ExternalFrameReader(this);
+	}
+
+	if (this->Options.ManualPump)
+	{
+		// nothing happens until the host pumps the player
+	}
+	else if (this->Options.SharedScheduler)
+	{
+		Scheduler::Get().Register(this);
+	}
+	else
+	{
+		this->Thread = new std::thread([this](){this->ThreadExecute();});
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Probe
+//-----------------------------------------------------------------------------
+bool Kimura::Player::Probe(PlaybackInformation& OutInfo)
+{
+	KIMURA_TRACE("Kimura::Player::Probe");
+
+	if (!this->OpenInputFile())
+	{
+		return false;
+	}
+
+	// only the metadata is needed, the frame tables are skipped
+	bool bSuccess = this->ReadTOC(true);
+	this->CloseInputFile();
+
+	if (!bSuccess)
+	{
+		return false;
+	}
+
+	this->Status = PlayerStatus::Ready;
+
+	return this->RetrievePlaybackInformation(OutInfo);
 }
 
 
@@ -69,6 +378,15 @@ Kimura::Player::Player(const std::string& InPath, const Kimura::PlayerOptions& I
 Kimura::Player::~Player()
 {
 	this->Stop(true);
+
+	// nothing else will be buffered
+	this->CompleteFrameRequests(true);
+
+	if (this->ExternalReader != nullptr)
+	{
+		delete this->ExternalReader;
+		this->ExternalReader = nullptr;
+	}
 }
 
 
@@ -111,14 +429,64 @@ void Kimura::Player::Stop(bool InWaitToComplete)
 {
 	KIMURA_TRACE("Kimura::Player::Stop");
 
-	this->StopThreadExecution = true;
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+		this->StopThreadExecution = true;
+	}
 	this->WakeUpBufferThreadEvent.notify_one();
-	if (InWaitToComplete)
+
+	if (InWaitToComplete && this->Thread != nullptr)
 	{
 		this->Thread->join();
 		delete this->Thread;
+		this->Thread = nullptr;
+	}
+
+	// without a thread of its own, the player is shut down by whoever stops it, once the scheduler is done with it
+	if (InWaitToComplete && this->Options.ManualPump)
+	{
+		// wait for a pump in progress on another thread
+		std::unique_lock<std::mutex> pumpLock(this->PumpMutex);
+		this->Shutdown();
+	}
+	else if (InWaitToComplete && this->Options.SharedScheduler)
+	{
+		Scheduler::Get().Unregister(this);
+		this->Shutdown();
+	}
+
+	// no longer asked for memory, nor waiting for it
+	if (InWaitToComplete)
+	{
+		MemoryBudget::Get().Unregister(this);
+	}
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::WakeUpBufferThread
+//-----------------------------------------------------------------------------
+void Kimura::Player::WakeUpBufferThread()
+{
+	if (this->Options.ManualPump)
+	{
+		// picked up on the next pump
+		return;
+	}
+
+	if (this->Options.SharedScheduler)
+	{
+		Scheduler::Get().WakeUp(this);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+		this->BufferThreadWorkPending = true;
 	}
 
+	this->WakeUpBufferThreadEvent.notify_one();
 }
 
 
@@ -138,1412 +506,7170 @@ void Kimura::Player::Failure(std::string InErrorMessage)
 //-----------------------------------------------------------------------------
 // Player::ReadTOC
 //-----------------------------------------------------------------------------
-bool Kimura::Player::ReadTOC()
+bool Kimura::Player::ReadTOC(bool InMetadataOnly /*= false*/)
 {
 	KIMURA_TRACE("Kimura::Player::ReadTOC");
 
 	this->Read<Version>(this->TOC.Version_);
 
+	if (this->TOC.Version_.CompatibleWith(LegacyTOCVersion))
+	{
+		return this->ReadLegacyTOC(InMetadataOnly);
+	}
+
 	if (!this->TOC.Version_.CompatibleWith(Version()))
 	{
 		this->Failure("Incompatible version");
 		return false;
 	}
 
-	this->Read(this->TOC.SourceFile);
-	this->Read(this->TOC.CreationDate);
+	// rest of the header
+	uint32 flags = 0;
+	uint64 metadataSize = 0;
+	uint64 pageDirectorySize = 0;
+	uint64 frameTablesSize = 0;
 
-	this->Read<float>(this->TOC.TimePerFrame);
-	this->Read<float>(this->TOC.FrameRate);
+	this->Read<uint32>(flags);
+	this->Read<uint64>(metadataSize);
+	this->Read<uint64>(pageDirectorySize);
+	this->Read<uint64>(frameTablesSize);
 
-	uint32 b16BitIndices = 0;
-	this->Read<uint32>(b16BitIndices);
-	this->TOC.Force16BitIndices = b16BitIndices ? true : false;
+	// metadata and page directory in a single read. The pages themselves are loaded on demand
+	uint64 sizeToRead = InMetadataOnly ? metadataSize : metadataSize + pageDirectorySize;
+	if (sizeToRead == 0 || sizeToRead > 0xffffffff)
+	{
+		this->Failure("Invalid table of content");
+		return false;
+	}
 
-	// meshes
+	std::vector<byte> toc((size_t)sizeToRead);
+	if (this->Read<byte>(toc[0], (uint32)sizeToRead) != (uint32)sizeToRead)
 	{
-		uint32 numMeshes = 0;
-		this->Read<uint32>(numMeshes);
+		this->Failure("Failed to read the table of content");
+		return false;
+	}
 
-		this->TOC.Meshes.resize(numMeshes);
+	// metadata
+	{
+		TOCBlockReader reader(toc.data(), metadataSize);
 
-		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
+		this->ReadTOCMetadata(reader);
+		reader.Read<uint32>(this->FramesPerTOCPage);
+
+		if (reader.Overflow)
 		{
-			TOCMesh& m = this->TOC.Meshes[iMesh];
+			this->Failure("Invalid table of content");
+			return false;
+		}
+	}
 
-			this->Read(m.Name);
+	if (InMetadataOnly)
+	{
+		return true;
+	}
 
-			this->Read<bool>(m.Constant);
-			this->Read<uint64>(m.MaxVertices);
-			this->Read<uint64>(m.MaxSurfaces);
-			this->Read<PositionFormat>(m.PositionFormat_);
-			this->Read<NormalFormat>(m.NormalFormat_);
-			this->Read<TangentFormat>(m.TangentFormat_);
-			this->Read<VelocityFormat>(m.VelocityFormat_);
-			this->Read<TexCoordFormat>(m.TexCoordFormat_);
-			this->Read<ColorFormat>(m.ColorFormat_);
+	// page directory
+	uint32 numPages = this->FramesPerTOCPage > 0 ? (this->TOC.NumFrames + this->FramesPerTOCPage - 1) / this->FramesPerTOCPage : 0;
+	if ((this->TOC.NumFrames > 0 && numPages == 0) || pageDirectorySize != (uint64)numPages * sizeof(TOCPageRecord))
+	{
+		this->Failure("Invalid table of content");
+		return false;
+	}
 
-		}
+	this->TOCPageDirectory.resize(numPages);
+	if (numPages > 0)
+	{
+		memcpy(this->TOCPageDirectory.data(), toc.data() + metadataSize, (size_t)pageDirectorySize);
 	}
 
+	this->CompressedTOCPages = (flags & TOCFlags_CompressedFrameTables) != 0;
 
+#if !defined(KIMURA_ZLIB)
+	if (this->CompressedTOCPages)
+	{
+		this->Failure("Compressed table of content requires the player to be built with zlib (KIMURAPLAYER_ZLIB)");
+		return false;
+	}
+#endif
 
-	// image sequences
 	{
-		uint32 numImageSequences = 0;		
-		this->Read<uint32>(numImageSequences);
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+		this->TOCPages.resize(numPages);
+	}
 
-		this->TOC.ImageSequences.resize(numImageSequences);
+	this->Frames.resize(this->TOC.NumFrames);
 
-		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
-		{
-			TOCImageSequence& IS = this->TOC.ImageSequences[iIS];
+	// right after the TOC comes the frame data
+	this->TOCPagesFilePosition = TOCHeaderSize + metadataSize + pageDirectorySize;
+	this->FrameDataFilePosition = this->TOCPagesFilePosition + frameTablesSize;
 
-			this->Read(IS.Name);
-			this->Read<ImageFormat>(IS.Format);
+	return true;
 
-			this->Read<bool>(IS.Constant);
-			this->Read<uint32>(IS.Width);
-			this->Read<uint32>(IS.Height);
-			this->Read<uint32>(IS.MipMapCount);
+}
 
 
-		}
+//-----------------------------------------------------------------------------
+// Player::ReadTOCMetadata
+//-----------------------------------------------------------------------------
+template<typename TReader>
+void Kimura::Player::ReadTOCMetadata(TReader& InReader)
+{
+	InReader.Read(this->TOC.SourceFile);
+	InReader.Read(this->TOC.CreationDate);
 
-	}
+	InReader.template Read<float>(this->TOC.TimePerFrame);
+	InReader.template Read<float>(this->TOC.FrameRate);
 
+	uint32 b16BitIndices = 0;
+	InReader.template Read<uint32>(b16BitIndices);
+	this->TOC.Force16BitIndices = b16BitIndices ? true : false;
 
-	// frames
+	// meshes
 	{
+		uint32 numMeshes = 0;
+		InReader.template Read<uint32>(numMeshes);
 
-		uint32 numFrames = 0;
-		this->Read<uint32>(numFrames);
-
-		this->TOC.Frames.resize(numFrames);
-
-		this->Frames.resize(numFrames);
+		this->TOC.Meshes.resize(numMeshes);
 
-		for (uint32 iFrame = 0; iFrame < numFrames; iFrame++)
+		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
 		{
-			TOCFrame& f = this->TOC.Frames[iFrame];
-
-			this->Read<uint64>(f.FilePosition);
-			this->Read<uint64>(f.BufferSize);
-
-			f.Meshes.resize(this->TOC.Meshes.size());
-
-			for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
-			{
-				TOCFrameMesh& fm = f.Meshes[iMesh];
-
-				this->Read<uint32>(fm.Vertices);
-				this->Read<uint32>(fm.Surfaces);
-
-				// read the mesh's sections
-				uint32 numSections = 0;
-				this->Read<uint32>(numSections);
+			TOCMesh& m = this->TOC.Meshes[iMesh];
 
-				fm.Sections.resize(numSections);
-				for (TOCFrameMeshSection& s : fm.Sections)
-				{
+			InReader.Read(m.Name);
 
-					this->Read<uint32>(s.VertexStart);
-					this->Read<uint32>(s.IndexStart);
-					this->Read<uint32>(s.NumSurfaces);
-					this->Read<uint32>(s.MinVertexIndex);
-					this->Read<uint32>(s.MaxVertexIndex);
+			InReader.template Read<bool>(m.Constant);
+			InReader.template Read<uint64>(m.MaxVertices);
+			InReader.template Read<uint64>(m.MaxSurfaces);
+			InReader.template Read<PositionFormat>(m.PositionFormat_);
+			InReader.template Read<NormalFormat>(m.NormalFormat_);
+			InReader.template Read<TangentFormat>(m.TangentFormat_);
+			InReader.template Read<VelocityFormat>(m.VelocityFormat_);
+			InReader.template Read<TexCoordFormat>(m.TexCoordFormat_);
+			InReader.template Read<ColorFormat>(m.ColorFormat_);
 
-				}
+		}
+	}
 
-				this->Read<int32>(fm.SeekIndices);
-				this->Read<uint32>(fm.SizeIndices);
+	// image sequences
+	{
+		uint32 numImageSequences = 0;		
+		InReader.template Read<uint32>(numImageSequences);
 
-				this->Read<int32>(fm.SeekPositions);
-				this->Read<uint32>(fm.SizePositions);
-				this->Read<Kimura::Vector3>(fm.PositionQuantizationCenter);
-				this->Read<Kimura::Vector3>(fm.PositionQuantizationExtents);
+		this->TOC.ImageSequences.resize(numImageSequences);
 
-				this->Read<int32>(fm.SeekNormals);
-				this->Read<uint32>(fm.SizeNormals);
+		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
+		{
+			TOCImageSequence& IS = this->TOC.ImageSequences[iIS];
 
-				this->Read<int32>(fm.SeekTangents);
-				this->Read<uint32>(fm.SizeTangents);
+			InReader.Read(IS.Name);
+			InReader.template Read<ImageFormat>(IS.Format);
 
-				this->Read<int32>(fm.SeekVelocities);
-				this->Read<uint32>(fm.SizeVelocities);
-				this->Read<Kimura::Vector3>(fm.VelocityQuantizationCenter);
-				this->Read<Kimura::Vector3>(fm.VelocityQuantizationExtents);
+			InReader.template Read<bool>(IS.Constant);
+			InReader.template Read<uint32>(IS.Width);
+			InReader.template Read<uint32>(IS.Height);
+			InReader.template Read<uint32>(IS.MipMapCount);
 
-				this->Read<int32>(fm.SeekTexCoords[0], MaxTextureCoords);
-				this->Read<uint32>(fm.SizeTexCoords[0], MaxTextureCoords);
+		}
 
-				this->Read<int32>(fm.SeekColors[0], MaxColorChannels);
-				this->Read<uint32>(fm.SizeColors[0], MaxColorChannels);
-				this->Read<Vector4>(fm.ColorQuantizationExtents[0], MaxColorChannels);
+	}
 
-				this->Read<Kimura::Vector3>(fm.BoundingCenter);
-				this->Read<Kimura::Vector3>(fm.BoundingSize);
+	InReader.template Read<uint32>(this->TOC.NumFrames);
+}
 
-				// determine dependency on previous frames
-				{
-					if (fm.SeekIndices == -1 ||
-						fm.SeekPositions == -1 ||
-						fm.SeekNormals == -1 ||
-						fm.SeekTangents == -1 ||
-						fm.SeekVelocities == -1)
-					{
-						fm.DependsOnPreviousFrame = true;
-					}
 
-					for (uint32 iTexCoord = 0; iTexCoord < MaxTextureCoords; iTexCoord++)
-					{
-						if (fm.SeekTexCoords[iTexCoord] == -1)
-						{
-							fm.DependsOnPreviousFrame = true;
-						}
-					}
+//-----------------------------------------------------------------------------
+// Player::ReadTOCPage
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ReadTOCPage(const byte* InData, uint64 InSize, uint32 InNumSections, TOCFrameTable& OutPage)
+{
+	KIMURA_TRACE("Kimura::Player::ReadTOCPage");
 
-					for (uint32 iColor = 0; iColor < MaxColorChannels; iColor++)
-					{
-						if (fm.SeekColors[iColor] == -1)
-						{
-							fm.DependsOnPreviousFrame = true;
-						}
-					}
+	uint32 firstFrame = OutPage.FirstFrame;
+	uint32 numFrames = std::min(this->FramesPerTOCPage, this->TOC.NumFrames - firstFrame);
+	uint32 numMeshes = (uint32)this->TOC.Meshes.size();
+	uint32 numImageSequences = (uint32)this->TOC.ImageSequences.size();
 
-					if (fm.DependsOnPreviousFrame)
-					{
+	uint64 expectedSize =	(uint64)numFrames * sizeof(TOCFrameRecord) +
+							(uint64)numFrames * numMeshes * sizeof(TOCFrameMeshRecord) +
+							(uint64)InNumSections * sizeof(TOCFrameMeshSection) +
+							(uint64)numFrames * numImageSequences * sizeof(TOCFrameImage);
 
-						uint32 iBackFrame = iFrame;
-
-						bool bFoundIndices = false;
-						bool bFoundPositions = false;
-						bool bFoundNormals = false;
-						bool bFoundTangents = false;
-						bool bFoundVelocities = false;
-						bool bFoundTextCoords0 = false;
-						bool bFoundTextCoords1 = false;
-						bool bFoundTextCoords2 = false;
-						bool bFoundTextCoords3 = false;
-						bool bFoundColor0 = false;
-						bool bFoundColor1 = false;
-
-						// backtrack until we find all the components needed for this mesh on this frame
-						while (iBackFrame > 0)
-						{
+	if (InSize != expectedSize)
+	{
+		return false;
+	}
 
-							TOCFrameMesh& previousFrameMesh = this->TOC.Frames[iBackFrame].Meshes[iMesh];
-
-							if (previousFrameMesh.SeekIndices != -1)
-								bFoundIndices = true;
-
-							if (previousFrameMesh.SeekPositions != -1)
-								bFoundPositions = true;
-
-							if (previousFrameMesh.SeekNormals != -1)
-								bFoundNormals = true;
-
-							if (previousFrameMesh.SeekTangents != -1)
-								bFoundTangents = true;
-
-							if (previousFrameMesh.SeekVelocities != -1)
-								bFoundVelocities = true;
-
-							static_assert(MaxTextureCoords == 4, "Maximum texcoord count changed");
-							if (previousFrameMesh.SeekTexCoords[0] != -1) { bFoundTextCoords0 = true; }
-							if (previousFrameMesh.SeekTexCoords[1] != -1) { bFoundTextCoords1 = true; }
-							if (previousFrameMesh.SeekTexCoords[2] != -1) { bFoundTextCoords2 = true; }
-							if (previousFrameMesh.SeekTexCoords[3] != -1) { bFoundTextCoords3 = true; }
-
-							static_assert(MaxColorChannels == 2, "Maximum color count changed");
-							if (previousFrameMesh.SeekColors[0] != -1) { bFoundColor0 = true; }
-							if (previousFrameMesh.SeekColors[1] != -1) { bFoundColor1 = true; }
-
-							// do we have all the data we need at this point?
-							if (bFoundIndices &&
-								bFoundPositions &&
-								bFoundNormals &&
-								bFoundTangents &&
-								bFoundVelocities &&
-								bFoundTextCoords0 &&
-								bFoundTextCoords1 &&
-								bFoundTextCoords2 &&
-								bFoundTextCoords3 &&
-								bFoundColor0 &&
-								bFoundColor1)
-							{
-								break;
-							}
-
-							iBackFrame--;
-						}
+	// position of each table in the page
+	TOCBlockReader frameReader(InData, InSize);
+	TOCBlockReader meshReader(InData, InSize);
+	meshReader.Position = (uint64)numFrames * sizeof(TOCFrameRecord);
+	TOCBlockReader sectionReader(InData, InSize);
+	sectionReader.Position = meshReader.Position + (uint64)numFrames * numMeshes * sizeof(TOCFrameMeshRecord);
+	TOCBlockReader imageReader(InData, InSize);
+	imageReader.Position = sectionReader.Position + (uint64)InNumSections * sizeof(TOCFrameMeshSection);
+
+	std::vector<TOCFrameMeshSection> sections(InNumSections);
+	if (InNumSections > 0)
+	{
+		sectionReader.Read<TOCFrameMeshSection>(sections[0], InNumSections);
+	}
 
-						fm.FrameIndexDependency = iBackFrame;
+	TOCFrameRecord frameRecord;
+	TOCFrameMeshRecord meshRecord;
+	TOCFrameImage frameImage;
 
-						// frame containing this mesh must also be updated. 
-						f.DependsOnPreviousFrame = true;
-						if (f.FrameIndexDependency < fm.FrameIndexDependency)
-						{
-							f.FrameIndexDependency = fm.FrameIndexDependency;
-						}
+	for (uint32 iFrame = firstFrame; iFrame < firstFrame + numFrames; iFrame++)
+	{
+		frameReader.Read<TOCFrameRecord>(frameRecord);
 
-					}
+		if (frameRecord.FrameIndexDependency > iFrame)
+		{
+			return false;
+		}
 
-				}
+		OutPage.AddFrame(frameRecord.FilePosition, frameRecord.BufferSize);
+		OutPage.FrameIndexDependencies.back() = frameRecord.FrameIndexDependency;
 
-			}
+		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
+		{
+			meshReader.Read<TOCFrameMeshRecord>(meshRecord);
 
-			// image sequences for this frame... 
-			f.Images.resize(this->TOC.ImageSequences.size());
-			for (uint32 iIS = 0; iIS < this->TOC.ImageSequences.size(); iIS++)
+			if ((uint64)meshRecord.FirstSection + meshRecord.NumSections > InNumSections)
 			{
-				TOCFrameImage& fi = f.Images[iIS];
-
-				this->Read<uint32>(fi.NumMipmaps);
-				for (uint32 iMipmap = 0; iMipmap < MaxMipmaps; iMipmap++)
-				{
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Width);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Height);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].RowPitch);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].SlicePitch);
-
-					this->Read<int32>(fi.Mipmaps[iMipmap].SeekPosition);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Size);
-
-				}
-
+				return false;
 			}
 
+			OutPage.AddFrameMesh(iMesh, meshRecord, sections.data() + meshRecord.FirstSection, meshRecord.NumSections);
 		}
 
+		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
+		{
+			imageReader.Read<TOCFrameImage>(frameImage);
+			OutPage.AddFrameImage(frameImage);
+		}
 	}
 
-
-#if defined(KIMURA_UNREAL)
-	this->FrameDataFilePosition = this->UEFileHandle->Tell();
-#elif defined(KIMURA_WINDOWS)
-	// right after the TOC comes the frame data, keep that position offset
-	this->FrameDataFilePosition = _tell(this->FileHandle);
-#else
-	this->FrameDataFilePosition = this->InputFile.tellg();
-#endif
+	OutPage.Finalize();
 
 	return true;
-
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::Read
+// Player::AcquireTOCPage
 //-----------------------------------------------------------------------------
-template<typename T>
-Kimura::uint32 Kimura::Player::Read(T& Out, uint32 InCount /*= 1*/)
+std::shared_ptr<const Kimura::TOCFrameTable> Kimura::Player::AcquireTOCPage(uint32 iFrame)
 {
+	KIMURA_TRACE("Kimura::Player::AcquireTOCPage");
 
-#if defined(KIMURA_UNREAL)
-
-	this->UEFileHandle->Read((uint8*)&Out, sizeof(Out) * InCount);
-	return sizeof(Out) * InCount;
-
-#elif defined(KIMURA_WINDOWS)
-
-	int bytesRead = _read(this->FileHandle, (void*)&Out, sizeof(Out) * InCount);
-	return bytesRead;
+	uint32 iPage = iFrame / this->FramesPerTOCPage;
 
-#else
-	uint64 posBefore = this->InputFile.tellg();
+	{
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
 
-	this->InputFile.read((char*)&Out, sizeof(Out) * InCount);
+		if (this->TOCPages[iPage] != nullptr)
+		{
+			return this->TOCPages[iPage];
+		}
+	}
 
-	uint64 posAfter = this->InputFile.tellg();
+	// drop the pages no longer needed before bringing in a new one
+	this->EvictTOCPages();
 
-	return (uint32)(posAfter - posBefore);
+	// the cursors of a clip share their pages
+	std::shared_ptr<TOCFrameTable> page = this->Clip_ != nullptr ? this->Clip_->AcquireTOCPage(iPage) : this->LoadTOCPage(iPage);
+	if (page == nullptr)
+	{
+		this->Failure("Failed to read the table of content");
+		return nullptr;
+	}
 
-#endif
+	{
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+		this->TOCPages[iPage] = page;
+	}
 
+	return page;
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::Read
+// Player::LoadTOCPage
 //-----------------------------------------------------------------------------
-Kimura::uint32 Kimura::Player::Read(std::string& s)
+std::shared_ptr<Kimura::TOCFrameTable> Kimura::Player::LoadTOCPage(uint32 iPage)
 {
+	KIMURA_TRACE("Kimura::Player::LoadTOCPage");
 
-#if defined(KIMURA_UNREAL)
+	if (iPage >= (uint32)this->TOCPageDirectory.size())
+	{
+		return nullptr;
+	}
 
-	int size_ = 0;
-	bool bRead = this->UEFileHandle->Read((uint8*)&size_, sizeof(size_));
+	const TOCPageRecord& pageRecord = this->TOCPageDirectory[iPage];
 
-	if (size_ > 0)
+	std::vector<byte> data(pageRecord.Size);
+	if (!this->DataSource->ReadAt(this->TOCPagesFilePosition + pageRecord.Offset, data.data(), pageRecord.Size))
 	{
-		char str[1024];
-		this->UEFileHandle->Read((uint8*)str, size_);
-		str[size_] = 0;
-
-		s = str;
+		return nullptr;
 	}
-	return sizeof(size_) + size_;
 
-#elif defined(KIMURA_WINDOWS)
+	if (this->CompressedTOCPages)
+	{
+#if defined(KIMURA_ZLIB)
 
-	int bytesRead = 0;
+		std::vector<byte> inflatedData(pageRecord.UncompressedSize);
 
-	int size = 0;
-	bytesRead = _read(this->FileHandle, (void*)&size, sizeof(size));
-	if (size > 0)
-	{
-		char str[1024];
-		bytesRead += _read(this->FileHandle, str, size);
-		str[size] = 0;
+		uLongf inflatedSize = (uLongf)pageRecord.UncompressedSize;
+		if (uncompress(inflatedData.data(), &inflatedSize, data.data(), (uLong)data.size()) != Z_OK || inflatedSize != pageRecord.UncompressedSize)
+		{
+			return nullptr;
+		}
 
-		s = str;
-	}
-	return bytesRead;
+		data.swap(inflatedData);
 
 #else
-	uint64 posBefore = this->InputFile.tellg();
 
-	int size = 0;
-	this->InputFile.read((char*)&size, sizeof(size));
-	if (size > 0)
-	{
-		char str[1024];
-		this->InputFile.read(str, sizeof(char) * size);
-		str[size] = 0;
+		return nullptr;
 
-		s = str;
+#endif
 	}
 
-	uint64 posAfter = this->InputFile.tellg();
+	std::shared_ptr<TOCFrameTable> page = std::make_shared<TOCFrameTable>();
+	page->Initialize(this->TOC, iPage * this->FramesPerTOCPage);
 
-	return (uint32)(posAfter - posBefore);
-#endif
+	if (!this->ReadTOCPage(data.data(), data.size(), pageRecord.NumSections, *page))
+	{
+		return nullptr;
+	}
+
+	return page;
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::ThreadExecute
+// Player::AdoptTOC
 //-----------------------------------------------------------------------------
-void Kimura::Player::ThreadExecute()
+void Kimura::Player::AdoptTOC(const Player& InSource)
 {
-	std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+	// the source's table of content is complete and no longer changes, its pages are loaded through the clip
+	this->TOC = InSource.TOC;
 
+	this->FramesPerTOCPage = InSource.FramesPerTOCPage;
+	this->CompressedTOCPages = InSource.CompressedTOCPages;
+	this->TOCPagesFilePosition = InSource.TOCPagesFilePosition;
+	this->TOCPageDirectory = InSource.TOCPageDirectory;
 
-	// open the file
 	{
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+		this->TOCPages = InSource.TOCPages;
+	}
 
-#if defined(KIMURA_UNREAL)
-
-		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-
-		FString sourceFilename(InputFilePath.c_str());
-
+	this->Frames.resize(this->TOC.NumFrames);
 
-		// check if the file exists
-		if (!PlatformFile.FileExists(*sourceFilename))
-		{
-			return this->Failure("Failed to open the input file: ");
-		}
+	this->FrameDataFilePosition = InSource.FrameDataFilePosition;
+}
 
-		this->UEFileHandle = PlatformFile.OpenRead(*sourceFilename);
 
-		if (this->UEFileHandle == nullptr)
-		{
-			return this->Failure("Failed to open the input file");
-		}
+//-----------------------------------------------------------------------------
+// Player::EvictTOCPages
+//-----------------------------------------------------------------------------
+void Kimura::Player::EvictTOCPages()
+{
+	// without a page directory, the whole table was read up front and stays resident
+	if (this->TOCPageDirectory.empty())
+	{
+		return;
+	}
 
+	// keep the pages covering the frames around the buffered window. Frames being read hold on to their own page.
+	uint32 numFrames = this->TOC.NumFrames;
+	uint32 windowStart = 0;
+	uint32 windowSize = 0;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
 
-#elif defined(KIMURA_WINDOWS)
-		if (_sopen_s(&this->FileHandle, this->InputFilePath.c_str(), _O_RDONLY | _O_BINARY, _SH_DENYNO, 0))
-		{
-			return this->Failure("Failed to open the input file: ");
-		}
-#else
+		// sized as playback goes with AdaptivePreBuffering
+		windowSize = this->Options.BackBufferSize + this->Options.PreBufferingSize + 1;
 
-/* requires c++ 17
+		uint32 currentFrame = this->GetFrameAtPosition(this->FullyBufferedFramesStart);
 
-		// validate access to alembic document
-		if (!std::filesystem::exists(this->InputFilePath))
+		if (this->Options.Direction == PlaybackDirection::Forward)
 		{
-			return this->Failure("Couldn't find input file");
+			windowStart = (currentFrame + numFrames - (this->Options.BackBufferSize % numFrames)) % numFrames;
 		}
-*/
-
-		this->InputFile.open(this->InputFilePath, std::ios::in | std::ios::binary);
-		if (!this->InputFile.is_open())
+		else
 		{
-			return this->Failure("Failed to open the input file: ");
+			// buffering heads either way, the pages on both sides of the current frame are kept
+			uint32 reach = std::min(this->Options.BackBufferSize + this->Options.PreBufferingSize, numFrames);
+			windowStart = (currentFrame + numFrames - reach) % numFrames;
+			windowSize = 2 * reach + 1;
 		}
-#endif
 	}
 
-	// read the table of content from the file
+	std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+
+	for (uint32 iPage = 0; iPage < (uint32)this->TOCPages.size(); iPage++)
 	{
-		if (!this->ReadTOC())
+		if (this->TOCPages[iPage] == nullptr)
 		{
-			// failed
-			return;
+			continue;
 		}
 
-		// success! ready to start loading frames
-		this->Status = PlayerStatus::Ready;
-	}
+		uint32 pageStart = iPage * this->FramesPerTOCPage;
+		uint32 pageSize = this->TOCPages[iPage]->GetNumFrames();
 
-	// adjust buffering sizes
-	if (this->Options.BufferEntirePlayback || this->Options.PreBufferingSize > (uint32)this->TOC.Frames.size())
-	{
-		this->Options.PreBufferingSize = (uint32)this->TOC.Frames.size();
-	}
+		// both ranges wrap around the end of the playback
+		bool bPageInWindow = (pageStart + numFrames - windowStart) % numFrames < windowSize ||
+							 (windowStart + numFrames - pageStart) % numFrames < pageSize;
 
-	// if any of the image sequences stored in the file is flagged as constant, we should read that frame and store it 
-	// immediately. 
-	bool bBufferFirstFrame = false;
-	for (const auto& imageSequence : this->TOC.ImageSequences)
-	{
-		if (imageSequence.Constant)
+		if (!bPageInWindow)
 		{
-			bBufferFirstFrame = true;
-			break;
+			this->TOCPages[iPage] = nullptr;
 		}
 	}
-	if (bBufferFirstFrame)
-	{
-		this->LoadFrameAt(0);
-		this->FirstFrame = this->Frames[0];
-	}
+}
 
-	while (!this->StopThreadExecution)
+
+//-----------------------------------------------------------------------------
+// Player::ReadLegacyTOC
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ReadLegacyTOC(bool InMetadataOnly)
+{
+	KIMURA_TRACE("Kimura::Player::ReadLegacyTOC");
+
+	this->ReadTOCMetadata(*this);
+
+	if (InMetadataOnly)
 	{
-		if (!this->BufferNextFrame())
-		{
-			// when buffer is full or contains sufficient frames, pause the thread
-			this->WakeUpBufferThreadEvent.wait(threadLock);
-		}	
+		return true;
 	}
 
-#if defined(KIMURA_UNREAL)
-	if (this->UEFileHandle != nullptr)
+	// frames
 	{
-		delete this->UEFileHandle;
-		this->UEFileHandle = nullptr;
-	}
-#elif defined(KIMURA_WINDOWS)
-	_close(this->FileHandle);
-	this->FileHandle = -1;
-#else
-	this->InputFile.close();
-#endif
-}
 
+		uint32 numFrames = this->TOC.NumFrames;
 
-//-----------------------------------------------------------------------------
-// Player::BufferNextFrame
-//-----------------------------------------------------------------------------
-bool Kimura::Player::BufferNextFrame()
-{
-	// find the index of the next frame to buffer
-	uint32 indexOfFrameToLoad = 0;	
-	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		// the whole table is read up front and kept as a single page
+		std::shared_ptr<TOCFrameTable> table = std::make_shared<TOCFrameTable>();
+		table->Initialize(this->TOC);
+		this->Frames.resize(numFrames);
 
-		if (this->FullyBufferedFramesCount >= this->Options.PreBufferingSize)
-		{
-			// sufficient number of frames are already buffered. There's no need to buffer another frame at this time. 
-			return false;
-		}
+		// records are read one at a time and packed right away
+		TOCFrameMesh fm;
+		TOCFrameImage fi;
 
-		indexOfFrameToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount;
-		
-		if (this->Options.Loop)
-		{
-			// wrap around
-			indexOfFrameToLoad %= (uint32)this->TOC.Frames.size();
-		}
-		else if (indexOfFrameToLoad >= (uint32)this->TOC.Frames.size())
+		for (uint32 iFrame = 0; iFrame < numFrames; iFrame++)
 		{
-			// Reached the end of the playback. No more frames to buffer
-			return false;
-		}
-	}
-
-	TOCFrame& tocFrame = this->TOC.Frames[indexOfFrameToLoad];
-
-	// get ref to previous frame
-	std::shared_ptr<Frame> previousFrame = indexOfFrameToLoad > 0 ? this->Frames[indexOfFrameToLoad - 1] : nullptr;
-
-	// if previous frame is required but isn't loaded, we need to backtrack a bit
-	if (previousFrame == nullptr && tocFrame.IsDependantOnPreviousFrame())
-	{
-		for (uint32 i = tocFrame.FrameIndexDependency; i < indexOfFrameToLoad; i++)
-		{	
-			// load as many frames as needed. However!! These frames cannot be considered as fully loaded and 
-			// buffered (because their very own dependencies might not be met)
-			this->LoadFrameAt(i);
-		}
-	}
-
-	// 
-// 	if (indexOfFrameToLoad == 0 && this->FirstFrame != nullptr)
-// 	{
-// 		this->Frames[indexOfFrameToLoad] = this->FirstFrame;
-// 	}
-// 	else
-	{
-		this->LoadFrameAt(indexOfFrameToLoad);
-	}
+			uint64 filePosition = 0;
+			uint64 bufferSize = 0;
 
-	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+			this->Read<uint64>(filePosition);
+			this->Read<uint64>(bufferSize);
 
-		uint32 indexOfFrameWeReallyWantLoadedNext = (this->FullyBufferedFramesStart + FullyBufferedFramesCount ) % (uint32)this->TOC.Frames.size();
+			table->AddFrame(filePosition, bufferSize);
 
-		if (indexOfFrameToLoad == indexOfFrameWeReallyWantLoadedNext)
-		{
-			this->FullyBufferedFramesCount++;
-		}
-		else
-		{
-			// adjust memory footprint
-			if (this->Frames[indexOfFrameToLoad] != nullptr)
+			for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
 			{
-				this->Profiling.MemoryUsageForFrames -= (uint64)this->Frames[indexOfFrameToLoad]->Buffer.size();
-			}
-
-			this->Frames[indexOfFrameToLoad] = nullptr;
-		}
-	}
-
-	// 
-	{
-		this->WaitForFrameBufferedEvent.notify_one();
-	}
+				this->Read<uint32>(fm.Vertices);
+				this->Read<uint32>(fm.Surfaces);
 
-	return true;
+				// read the mesh's sections
+				uint32 numSections = 0;
+				this->Read<uint32>(numSections);
 
-}
+				fm.Sections.resize(numSections);
+				for (TOCFrameMeshSection& s : fm.Sections)
+				{
 
+					this->Read<uint32>(s.VertexStart);
+					this->Read<uint32>(s.IndexStart);
+					this->Read<uint32>(s.NumSurfaces);
+					this->Read<uint32>(s.MinVertexIndex);
+					this->Read<uint32>(s.MaxVertexIndex);
 
-//-----------------------------------------------------------------------------
-// Player::LoadFrameAt
-//-----------------------------------------------------------------------------
-void Kimura::Player::LoadFrameAt(uint32 iFrame)
-{
-	KIMURA_TRACE("Kimura::Player::LoadFrameAt");
+				}
 
-	TOCFrame& tocFrame = this->TOC.Frames[iFrame];
+				this->Read<int32>(fm.SeekIndices);
+				this->Read<uint32>(fm.SizeIndices);
 
-	// get ref to previous frame (if any or necessary)
-	std::shared_ptr<Frame> previousFrame = iFrame > 0 ? this->Frames[iFrame - 1] : nullptr;
+				this->Read<int32>(fm.SeekPositions);
+				this->Read<uint32>(fm.SizePositions);
+				this->Read<Kimura::Vector3>(fm.PositionQuantizationCenter);
+				this->Read<Kimura::Vector3>(fm.PositionQuantizationExtents);
 
-	std::shared_ptr<Frame> newFrame = std::make_shared<Frame>();
-	newFrame->FrameIndex = iFrame;
+				this->Read<int32>(fm.SeekNormals);
+				this->Read<uint32>(fm.SizeNormals);
 
-	// keep references to other frames alive as long as this frame is
-	if (tocFrame.IsDependantOnPreviousFrame())
-	{
-		uint32 numFramesDependentOn = iFrame - tocFrame.FrameIndexDependency;
+				this->Read<int32>(fm.SeekTangents);
+				this->Read<uint32>(fm.SizeTangents);
 
-		newFrame->FrameDependencies.reserve(numFramesDependentOn);
-		for (uint32 i = tocFrame.FrameIndexDependency; i < iFrame; i++)
-		{
-			newFrame->FrameDependencies.push_back(this->Frames[i]);
-		}
+				this->Read<int32>(fm.SeekVelocities);
+				this->Read<uint32>(fm.SizeVelocities);
+				this->Read<Kimura::Vector3>(fm.VelocityQuantizationCenter);
+				this->Read<Kimura::Vector3>(fm.VelocityQuantizationExtents);
 
-	}
+				this->Read<int32>(fm.SeekTexCoords[0], MaxTextureCoords);
+				this->Read<uint32>(fm.SizeTexCoords[0], MaxTextureCoords);
 
-	// allocate a buffer large enough to contain the entire frame
-	newFrame->Buffer.resize(tocFrame.BufferSize);
-	this->Profiling.BytesReadInLastSecond += tocFrame.BufferSize;
-	this->Profiling.MemoryUsageForFrames += tocFrame.BufferSize;
+				this->Read<int32>(fm.SeekColors[0], MaxColorChannels);
+				this->Read<uint32>(fm.SizeColors[0], MaxColorChannels);
+				this->Read<Vector4>(fm.ColorQuantizationExtents[0], MaxColorChannels);
 
-	{
-		ScopedTime s;
+				this->Read<Kimura::Vector3>(fm.BoundingCenter);
+				this->Read<Kimura::Vector3>(fm.BoundingSize);
 
-		KIMURA_TRACE("Kimura::Player::LoadFrameAt::read");
+				table->AddFrameMesh(iMesh, fm, fm.Sections.data(), (uint32)fm.Sections.size());
+			}
 
-		// seek and read the frame's content into the buffer
+			// image sequences for this frame... 
+			for (uint32 iIS = 0; iIS < this->TOC.ImageSequences.size(); iIS++)
+			{
+				this->Read<uint32>(fi.NumMipmaps);
+				for (uint32 iMipmap = 0; iMipmap < MaxMipmaps; iMipmap++)
+				{
+					this->Read<uint32>(fi.Mipmaps[iMipmap].Width);
+					this->Read<uint32>(fi.Mipmaps[iMipmap].Height);
+					this->Read<uint32>(fi.Mipmaps[iMipmap].RowPitch);
+					this->Read<uint32>(fi.Mipmaps[iMipmap].SlicePitch);
 
-		uint64 positionOfFrameInFile = this->FrameDataFilePosition + tocFrame.FilePosition;
+					this->Read<int32>(fi.Mipmaps[iMipmap].SeekPosition);
+					this->Read<uint32>(fi.Mipmaps[iMipmap].Size);
 
-#if defined(KIMURA_UNREAL)
+				}
 
-		bool bSeek = this->UEFileHandle->Seek(positionOfFrameInFile);
-		if (!bSeek)
-		{
-			return this->Failure("Failed to seek in file");
-		}
+				table->AddFrameImage(fi);
+			}
 
-		bool bRead = this->UEFileHandle->Read((uint8*)newFrame->Buffer.data(), tocFrame.BufferSize);
-		if (!bRead)
-		{
-			return this->Failure("Failed to read frame data from file");
 		}
 
-#elif defined(KIMURA_WINDOWS) 
-
-
-		Kimura::uint64 newOffset = _lseeki64(this->FileHandle, positionOfFrameInFile, SEEK_SET);
-
-		int bytesRead = _read(this->FileHandle, (void*)newFrame->Buffer.data(), (unsigned int)tocFrame.BufferSize);
-
-#else
-		this->InputFile.seekg(positionOfFrameInFile);
-		this->InputFile.read((char*)newFrame->Buffer.data(), tocFrame.BufferSize);
-#endif
+		table->Finalize();
+		table->ResolveFrameDependencies(this->TOC);
 
-		this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond += s.Duration();
+		this->FramesPerTOCPage = std::max(numFrames, 1u);
 
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+		this->TOCPages.assign(1, table);
 	}
 
-	// allocate mesh instances for this frame
-	newFrame->Meshes.resize(tocFrame.Meshes.size());
-
-	byte* bufferAddress = newFrame->Buffer.data();
-
-	ScopedTime timeProcessingFrame;
+	// right after the TOC comes the frame data, keep that position offset
+	this->FrameDataFilePosition = this->ReadPosition;
 
+	return true;
 
-	for (uint32 iMesh = 0; iMesh < (uint32)newFrame->Meshes.size(); iMesh++)
-	{
-		FrameMesh& frameMesh = newFrame->Meshes[iMesh];
+}
 
-		TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
-		TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
 
-		frameMesh.Vertices = tocFrameMesh.Vertices;
-		frameMesh.Surfaces = tocFrameMesh.Surfaces;
+//-----------------------------------------------------------------------------
+// TOCFrameTable::ResolveFrameDependencies
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::ResolveFrameDependencies(const TableOfContent& InTOC)
+{
+	KIMURA_TRACE("Kimura::TOCFrameTable::ResolveFrameDependencies");
 
-		// a simple copy of the frame mesh's sections
-		frameMesh.Sections = tocFrameMesh.Sections;
+	// A Seek of -1 means the data is the same as in the previous frame. For each attribute, remember the last 
+	// frame that actually stored it: a frame needs every frame from the oldest of those onward to be resolved.
+	// The table is expected to start at the first frame of the playback.
+	TOCFrameTable& table = *this;
 
-		frameMesh.PositionQuantizationCenter = tocFrameMesh.PositionQuantizationCenter;
-		frameMesh.PositionQuantizationExtents = tocFrameMesh.PositionQuantizationExtents;
+	uint32 numMeshes = (uint32)InTOC.Meshes.size();
+	uint32 numImageSequences = (uint32)InTOC.ImageSequences.size();
 
-		frameMesh.VelocityQuantizationCenter = tocFrameMesh.VelocityQuantizationCenter;
-		frameMesh.VelocityQuantizationExtents = tocFrameMesh.VelocityQuantizationExtents;
+	std::vector<uint32> lastMeshAttributeFrames(numMeshes * MeshAttribute_Count, 0);
+	std::vector<uint32> lastMipmapFrames(numImageSequences * MaxMipmaps, 0);
 
-		frameMesh.ColorQuantizationExtents[0] = tocFrameMesh.ColorQuantizationExtents[0];
-		frameMesh.ColorQuantizationExtents[1] = tocFrameMesh.ColorQuantizationExtents[1];
+	int32 seeks[MeshAttribute_Count];
+	uint32 sizes[MeshAttribute_Count];
 
-		// copy bounds info
-		frameMesh.BoundingCenter = tocFrameMesh.BoundingCenter;
-		frameMesh.BoundingSize = tocFrameMesh.BoundingSize;
+	for (uint32 iFrame = 0; iFrame < table.GetNumFrames(); iFrame++)
+	{
+		uint32 frameIndexDependency = iFrame;
 
-		// number of vertices stored in this frame determines the type of index buffer used
-		if (frameMesh.Vertices <= 0xfffe || this->TOC.Force16BitIndices)
+		for (uint32 iEntry = table.FirstMeshEntries[iFrame]; iEntry < table.FirstMeshEntries[iFrame + 1]; iEntry++)
 		{
-			// 16bit indices
+			uint32 iMesh = table.MeshIndices[iEntry];
+			uint32 mask = table.MeshAttributeMasks[iMesh];
+			uint32* lastFrames = &lastMeshAttributeFrames[iMesh * MeshAttribute_Count];
 
-			if (tocFrameMesh.SeekIndices == -1)
+			table.GetAttributes(iEntry, seeks, sizes);
+
+			for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
 			{
-				// re-use previous frame's indices
-				if (previousFrame != nullptr)
+				if ((mask & (1 << iAttribute)) == 0)
 				{
-					frameMesh.IndicesU16 = previousFrame->Meshes[iMesh].IndicesU16;
+					continue;
 				}
-			}
-			else if (tocFrameMesh.SizeIndices > 0)
-			{
-				frameMesh.IndicesU16 = (uint16*)&bufferAddress[tocFrameMesh.SeekIndices];
-			}
-		}
-		else
-		{
-			// 32bit indices
 
-			if (tocFrameMesh.SeekIndices == -1)
-			{
-				// re-use previous frame's indices
-				if (previousFrame != nullptr)
+				if (seeks[iAttribute] != -1)
 				{
-					frameMesh.IndicesU32 = previousFrame->Meshes[iMesh].IndicesU32;
+					lastFrames[iAttribute] = iFrame;
+				}
+				else if (frameIndexDependency > lastFrames[iAttribute])
+				{
+					frameIndexDependency = lastFrames[iAttribute];
 				}
-			}
-			else if (tocFrameMesh.SizeIndices > 0)
-			{
-				frameMesh.IndicesU32 = (uint32*)&bufferAddress[tocFrameMesh.SeekIndices];
 			}
 		}
 
-		// position
-		switch (tocMesh.PositionFormat_)
+		// mipmaps of constant image sequences are always taken from the first frame, they don't count
+		uint32 iMipmapEntry = table.FirstMipmapEntries[iFrame];
+		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
 		{
-			case PositionFormat::Full:
+			uint32 numMipmaps = table.NumMipmaps[iFrame * numImageSequences + iIS];
+			uint32* lastFrames = &lastMipmapFrames[iIS * MaxMipmaps];
+
+			for (uint32 iMipmap = 0; iMipmap < numMipmaps; iMipmap++, iMipmapEntry++)
 			{
-				if (tocFrameMesh.SeekPositions == -1)
-				{
-					// re-use previous frame's positions
-					if (previousFrame != nullptr)
-					{
-						frameMesh.PositionsF32 = previousFrame->Meshes[iMesh].PositionsF32;
-					}
-				}
-				else if (tocFrameMesh.SizePositions > 0)
+				if (InTOC.ImageSequences[iIS].Constant)
 				{
-					frameMesh.PositionsF32 = (Vector3*) &bufferAddress[tocFrameMesh.SeekPositions];
+					continue;
 				}
 
-				break;
-
-			}
-
-			case PositionFormat::Half:
-			{				
-				if (tocFrameMesh.SeekPositions == -1)
+				if (table.MipmapSeeks[iMipmapEntry] != -1)
 				{
-					// re-use previous frame's positions
-					if (previousFrame != nullptr)
-					{
-						frameMesh.PositionsI16 = previousFrame->Meshes[iMesh].PositionsI16;
-					}
+					lastFrames[iMipmap] = iFrame;
 				}
-				else if (tocFrameMesh.SizePositions > 0)
+				else if (frameIndexDependency > lastFrames[iMipmap])
 				{
-					frameMesh.PositionsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekPositions];
+					frameIndexDependency = lastFrames[iMipmap];
 				}
-
-				break;
 			}
 		}
 
-		// normal
-		switch (tocMesh.NormalFormat_)
-		{
-			case NormalFormat::Full:
-			{
-				if (tocFrameMesh.SeekNormals == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.NormalsF32 = previousFrame->Meshes[iMesh].NormalsF32;
-					}
-				}
-				else if (tocFrameMesh.SizeNormals > 0)
-				{
-					frameMesh.NormalsF32 = (Vector3*) &bufferAddress[tocFrameMesh.SeekNormals];
-				}
+		table.FrameIndexDependencies[iFrame] = frameIndexDependency;
+	}
+}
 
-				break;
-			}
 
-			case NormalFormat::Half:
-			{
-				if (tocFrameMesh.SeekNormals == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.NormalsI16 = previousFrame->Meshes[iMesh].NormalsI16;
-					}
-				}
-				else if (tocFrameMesh.SizeNormals > 0)
-				{
-					frameMesh.NormalsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekNormals];
-				}
+//-----------------------------------------------------------------------------
+// TOCFrameTable::Initialize
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::Initialize(const TableOfContent& InTOC, uint32 InFirstFrame /*= 0*/)
+{
+	*this = TOCFrameTable();
 
-				break;
-			}
+	this->FirstFrame = InFirstFrame;
 
-			case NormalFormat::Byte:
-			{
-				if (tocFrameMesh.SeekNormals == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.NormalsI8 = previousFrame->Meshes[iMesh].NormalsI8;
-					}
-				}
-				else if (tocFrameMesh.SizeNormals > 0)
-				{
-					frameMesh.NormalsI8 = (int8*)&bufferAddress[tocFrameMesh.SeekNormals];
-				}
+	// attributes not stored by a mesh are never resolved, their seek and size are dropped
+	this->MeshAttributeMasks.resize(InTOC.Meshes.size());
+	for (uint32 iMesh = 0; iMesh < (uint32)InTOC.Meshes.size(); iMesh++)
+	{
+		const TOCMesh& m = InTOC.Meshes[iMesh];
 
-				break;
-			}
+		uint32 mask = (1 << MeshAttribute_Indices) | (1 << MeshAttribute_Positions);
 
-			case NormalFormat::None:
-			default:
-			{
-				break;
-			}
+		if (m.NormalFormat_ != NormalFormat::None)
+		{
+			mask |= 1 << MeshAttribute_Normals;
+		}
 
+		if (m.TangentFormat_ != TangentFormat::None)
+		{
+			mask |= 1 << MeshAttribute_Tangents;
 		}
 
+		if (m.VelocityFormat_ != VelocityFormat::None)
+		{
+			mask |= 1 << MeshAttribute_Velocities;
+		}
 
-		// Tangent
-		switch (tocMesh.TangentFormat_)
+		if (m.TexCoordFormat_ != TexCoordFormat::None)
 		{
-			case TangentFormat::Full:
-			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsF32 = previousFrame->Meshes[iMesh].TangentsF32;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsF32 = (Vector4*) &bufferAddress[tocFrameMesh.SeekTangents];
-				}
+			mask |= ((1 << MaxTextureCoords) - 1) << MeshAttribute_TexCoords;
+		}
 
-				break;
-			}
+		if (m.ColorFormat_ != ColorFormat::None)
+		{
+			mask |= ((1 << MaxColorChannels) - 1) << MeshAttribute_Colors;
+		}
 
-			case TangentFormat::Half:
-			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsI16 = previousFrame->Meshes[iMesh].TangentsI16;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekTangents];
-				}
+		this->MeshAttributeMasks[iMesh] = mask;
+	}
+}
 
-				break;
-			}
 
-			case TangentFormat::Byte:
+//-----------------------------------------------------------------------------
+// TOCFrameTable::AddFrame
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::AddFrame(uint64 InFilePosition, uint64 InBufferSize)
+{
+	this->FrameIndexDependencies.push_back(this->FirstFrame + (uint32)this->FilePositions.size());
+	this->FilePositions.push_back(InFilePosition);
+	this->BufferSizes.push_back((uint32)InBufferSize);		// seeks within a frame are 32 bits
+	this->FirstMeshEntries.push_back((uint32)this->MeshIndices.size());
+	this->FirstMipmapEntries.push_back((uint32)this->MipmapSeeks.size());
+}
+
+
+//-----------------------------------------------------------------------------
+// TOCFrameTable::AddFrameImage
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::AddFrameImage(const TOCFrameImage& InFrameImage)
+{
+	uint32 numMipmaps = InFrameImage.NumMipmaps < MaxMipmaps ? InFrameImage.NumMipmaps : MaxMipmaps;
+
+	this->NumMipmaps.push_back((uint8)numMipmaps);
+
+	for (uint32 iMipmap = 0; iMipmap < numMipmaps; iMipmap++)
+	{
+		this->MipmapSeeks.push_back(InFrameImage.Mipmaps[iMipmap].SeekPosition);
+		this->MipmapSizes.push_back(InFrameImage.Mipmaps[iMipmap].Size);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// TOCFrameTable::Finalize
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::Finalize()
+{
+	// close the ranges of the last frame
+	this->FirstMeshEntries.push_back((uint32)this->MeshIndices.size());
+	this->FirstMipmapEntries.push_back((uint32)this->MipmapSeeks.size());
+
+	// the tables grew while parsing, give back what wasn't used
+	this->FilePositions.shrink_to_fit();
+	this->BufferSizes.shrink_to_fit();
+	this->FrameIndexDependencies.shrink_to_fit();
+	this->FirstMeshEntries.shrink_to_fit();
+	this->FirstMipmapEntries.shrink_to_fit();
+	this->NumMipmaps.shrink_to_fit();
+	this->MeshIndices.shrink_to_fit();
+	this->Vertices.shrink_to_fit();
+	this->Surfaces.shrink_to_fit();
+	this->FirstSections.shrink_to_fit();
+	this->NumSections.shrink_to_fit();
+	this->FirstAttributes.shrink_to_fit();
+	this->PositionQuantizationCenters.shrink_to_fit();
+	this->PositionQuantizationExtents.shrink_to_fit();
+	this->VelocityQuantizationCenters.shrink_to_fit();
+	this->VelocityQuantizationExtents.shrink_to_fit();
+	this->ColorQuantizationExtents.shrink_to_fit();
+	this->BoundingCenters.shrink_to_fit();
+	this->BoundingSizes.shrink_to_fit();
+	this->Sections.shrink_to_fit();
+	this->AttributeSeeks.shrink_to_fit();
+	this->AttributeSizes.shrink_to_fit();
+	this->MipmapSeeks.shrink_to_fit();
+	this->MipmapSizes.shrink_to_fit();
+}
+
+
+//-----------------------------------------------------------------------------
+// TOCFrameTable::GetAttributes
+//-----------------------------------------------------------------------------
+void Kimura::TOCFrameTable::GetAttributes(uint32 InEntry, int32* OutSeeks, uint32* OutSizes) const
+{
+	uint32 mask = this->MeshAttributeMasks[this->MeshIndices[InEntry]];
+	uint32 iStored = this->FirstAttributes[InEntry];
+
+	for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+	{
+		if (mask & (1 << iAttribute))
+		{
+			OutSeeks[iAttribute] = this->AttributeSeeks[iStored];
+			OutSizes[iAttribute] = this->AttributeSizes[iStored];
+			iStored++;
+		}
+		else
+		{
+			OutSeeks[iAttribute] = 0;
+			OutSizes[iAttribute] = 0;
+		}
+	}
+}
+
+
+namespace Kimura
+{
+	template<typename T>
+	inline uint64 GetVectorMemoryUsage(const std::vector<T>& InVector)
+	{
+		return (uint64)InVector.capacity() * sizeof(T);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// TOCFrameTable::GetMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::TOCFrameTable::GetMemoryUsage() const
+{
+	return	GetVectorMemoryUsage(this->FilePositions) +
+			GetVectorMemoryUsage(this->BufferSizes) +
+			GetVectorMemoryUsage(this->FrameIndexDependencies) +
+			GetVectorMemoryUsage(this->FirstMeshEntries) +
+			GetVectorMemoryUsage(this->FirstMipmapEntries) +
+			GetVectorMemoryUsage(this->MeshIndices) +
+			GetVectorMemoryUsage(this->Vertices) +
+			GetVectorMemoryUsage(this->Surfaces) +
+			GetVectorMemoryUsage(this->FirstSections) +
+			GetVectorMemoryUsage(this->NumSections) +
+			GetVectorMemoryUsage(this->FirstAttributes) +
+			GetVectorMemoryUsage(this->PositionQuantizationCenters) +
+			GetVectorMemoryUsage(this->PositionQuantizationExtents) +
+			GetVectorMemoryUsage(this->VelocityQuantizationCenters) +
+			GetVectorMemoryUsage(this->VelocityQuantizationExtents) +
+			GetVectorMemoryUsage(this->ColorQuantizationExtents) +
+			GetVectorMemoryUsage(this->BoundingCenters) +
+			GetVectorMemoryUsage(this->BoundingSizes) +
+			GetVectorMemoryUsage(this->Sections) +
+			GetVectorMemoryUsage(this->AttributeSeeks) +
+			GetVectorMemoryUsage(this->AttributeSizes) +
+			GetVectorMemoryUsage(this->NumMipmaps) +
+			GetVectorMemoryUsage(this->MipmapSeeks) +
+			GetVectorMemoryUsage(this->MipmapSizes) +
+			GetVectorMemoryUsage(this->MeshAttributeMasks);
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::Create
+//-----------------------------------------------------------------------------
+std::shared_ptr<const Kimura::FrameDataSelection> Kimura::FrameDataSelection::Create(const std::vector<bool>& InMeshes, uint32 InAttributes,
+	const std::vector<uint32>& InMinimumMipmaps, bool InDeferImages)
+{
+	const uint32 allAttributes = (1u << MeshAttribute_Count) - 1;
+
+	bool bAllMipmaps = std::find_if(InMinimumMipmaps.begin(), InMinimumMipmaps.end(), [](uint32 InMipmap) { return InMipmap > 0; }) == InMinimumMipmaps.end();
+
+	if (InMeshes.empty() && (InAttributes & allAttributes) == allAttributes && bAllMipmaps && !InDeferImages)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<FrameDataSelection> selection = std::make_shared<FrameDataSelection>();
+	selection->Meshes = InMeshes;
+	selection->Attributes = InAttributes;
+	selection->DeferImages = InDeferImages;
+
+	if (!bAllMipmaps)
+	{
+		selection->MinimumMipmaps = InMinimumMipmaps;
+	}
+
+	return selection;
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::CreateReused
+//-----------------------------------------------------------------------------
+std::shared_ptr<const Kimura::FrameDataSelection> Kimura::FrameDataSelection::CreateReused(const std::shared_ptr<const FrameDataSelection>& InSelection,
+	const std::vector<uint32>& InAttributes, const std::vector<uint32>& InMipmaps)
+{
+	std::shared_ptr<FrameDataSelection> selection = std::make_shared<FrameDataSelection>(Get(InSelection));
+	selection->ReusedDataOnly = true;
+	selection->ReusedAttributes = InAttributes;
+	selection->ReusedMipmaps = InMipmaps;
+
+	return selection;
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::Get
+//-----------------------------------------------------------------------------
+const Kimura::FrameDataSelection& Kimura::FrameDataSelection::Get(const std::shared_ptr<const FrameDataSelection>& InSelection)
+{
+	static const FrameDataSelection everything;
+
+	return InSelection != nullptr ? *InSelection : everything;
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::Same
+//-----------------------------------------------------------------------------
+bool Kimura::FrameDataSelection::Same(const std::shared_ptr<const FrameDataSelection>& InA, const std::shared_ptr<const FrameDataSelection>& InB)
+{
+	const FrameDataSelection& a = Get(InA);
+	const FrameDataSelection& b = Get(InB);
+
+	return	SameMeshData(InA, InB) && a.MinimumMipmaps == b.MinimumMipmaps && a.DeferImages == b.DeferImages && 
+			a.ReusedMipmaps == b.ReusedMipmaps;
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::SameMeshData
+//-----------------------------------------------------------------------------
+bool Kimura::FrameDataSelection::SameMeshData(const std::shared_ptr<const FrameDataSelection>& InA, const std::shared_ptr<const FrameDataSelection>& InB)
+{
+	const FrameDataSelection& a = Get(InA);
+	const FrameDataSelection& b = Get(InB);
+
+	return	a.Meshes == b.Meshes && a.Attributes == b.Attributes && 
+			a.ReusedDataOnly == b.ReusedDataOnly && a.ReusedAttributes == b.ReusedAttributes;
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameDataSelection::GatherRanges
+//-----------------------------------------------------------------------------
+void Kimura::FrameDataSelection::GatherRanges(const TOCFrameTable& InTable, uint32 iFrame, std::vector<FrameDataRange>& OutRanges) const
+{
+	uint32 iFrameInPage = iFrame - InTable.FirstFrame;
+
+	OutRanges.clear();
+
+	int32 seeks[MeshAttribute_Count];
+	uint32 sizes[MeshAttribute_Count];
+
+	// data reused from previous frames (seek of -1) isn't part of this frame's data
+	for (uint32 iEntry = InTable.FirstMeshEntries[iFrameInPage]; iEntry < InTable.FirstMeshEntries[iFrameInPage + 1]; iEntry++)
+	{
+		uint32 iMesh = InTable.MeshIndices[iEntry];
+
+		InTable.GetAttributes(iEntry, seeks, sizes);
+
+		for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+		{
+			if (seeks[iAttribute] != -1 && sizes[iAttribute] > 0 && this->Includes(iMesh, iAttribute))
 			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsI8 = previousFrame->Meshes[iMesh].TangentsI8;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsI8 = (int8*)&bufferAddress[tocFrameMesh.SeekTangents];
-				}
+				FrameDataRange range;
+				range.Offset = (uint32)seeks[iAttribute];
+				range.Size = sizes[iAttribute];
+				OutRanges.push_back(range);
+			}
+		}
+	}
 
-				break;
+	// mipmaps from the minimum one of each image sequence
+	uint32 numImageSequences = InTable.GetNumFrames() > 0 ? (uint32)(InTable.NumMipmaps.size() / InTable.GetNumFrames()) : 0;
+	uint32 iMipmapEntry = InTable.FirstMipmapEntries[iFrameInPage];
+
+	for (uint32 iImageSequence = 0; iImageSequence < numImageSequences; iImageSequence++)
+	{
+		uint32 numMipmaps = InTable.NumMipmaps[iFrameInPage * numImageSequences + iImageSequence];
+
+		for (uint32 iMipmap = 0; iMipmap < numMipmaps; iMipmap++, iMipmapEntry++)
+		{
+			if (this->IncludesMipmap(iImageSequence, iMipmap, numMipmaps) && InTable.MipmapSeeks[iMipmapEntry] != -1 && InTable.MipmapSizes[iMipmapEntry] > 0)
+			{
+				FrameDataRange range;
+				range.Offset = (uint32)InTable.MipmapSeeks[iMipmapEntry];
+				range.Size = InTable.MipmapSizes[iMipmapEntry];
+				range.Image = true;
+				OutRanges.push_back(range);
 			}
+		}
+	}
 
-			case TangentFormat::None:
-			default:
+	// in the order of the file, ranges overlapping or close to each other merged into one. Mesh data and images are
+	// kept apart, they may be read at different times.
+	std::sort(OutRanges.begin(), OutRanges.end(), [](const FrameDataRange& InA, const FrameDataRange& InB) { return InA.Offset < InB.Offset; });
+
+	size_t numRanges = 0;
+	for (size_t iRange = 0; iRange < OutRanges.size(); iRange++)
+	{
+		FrameDataRange range = OutRanges[iRange];
+
+		if (numRanges > 0)
+		{
+			FrameDataRange& previousRange = OutRanges[numRanges - 1];
+			uint64 previousEnd = (uint64)previousRange.Offset + previousRange.Size;
+
+			if (range.Image == previousRange.Image && (uint64)range.Offset <= previousEnd + MaxSkippedFrameDataGap)
 			{
-				break;
+				previousRange.Size = (uint32)(std::max(previousEnd, (uint64)range.Offset + range.Size) - previousRange.Offset);
+				continue;
 			}
+		}
+
+		OutRanges[numRanges++] = range;
+	}
+
+	OutRanges.resize(numRanges);
+
+	// back to back in the frame's buffer
+	uint32 bufferOffset = 0;
+	for (FrameDataRange& range : OutRanges)
+	{
+		bufferOffset += (range.Offset - bufferOffset) & (FrameDataRangeAlignment - 1);
+
+		range.BufferOffset = bufferOffset;
+		bufferOffset += range.Size;
+	}
+}
+
+
+
+//-----------------------------------------------------------------------------
+// Player::Read
+//-----------------------------------------------------------------------------
+template<typename T>
+Kimura::uint32 Kimura::Player::Read(T& Out, uint32 InCount /*= 1*/)
+{
+	uint64 size = sizeof(Out) * InCount;
+
+	if (!this->DataSource->ReadAt(this->ReadPosition, (void*)&Out, size))
+	{
+		return 0;
+	}
+
+	this->ReadPosition += size;
+
+	return (uint32)size;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Read
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::Read(std::string& s)
+{
+	int size = 0;
+	uint32 bytesRead = this->Read<int>(size);
 
+	if (size > 0)
+	{
+		char str[1024];
+		if (size >= (int)sizeof(str) || this->Read<char>(str[0], (uint32)size) != (uint32)size)
+		{
+			return bytesRead;
 		}
+		str[size] = 0;
 
+		s = str;
+		bytesRead += (uint32)size;
+	}
 
+	return bytesRead;
+}
 
-		// velocity
-		switch (tocMesh.VelocityFormat_)
+
+//-----------------------------------------------------------------------------
+// Player::OpenInputFile
+//-----------------------------------------------------------------------------
+bool Kimura::Player::OpenInputFile()
+{
+	// players given a byte source, and the cursors of a clip, read through the one they have
+	if (this->DataSource == nullptr)
+	{
+		std::shared_ptr<FileByteSource> file = std::make_shared<FileByteSource>();
+		if (!file->Open(this->InputFilePath))
+		{
+			this->Failure("Failed to open the input file: ");
+			return false;
+		}
+
+		this->DataSource = file;
+
+		// slowed down for tests if requested, in the options or in the environment
+		ThrottleSettings throttle = this->Options.Throttle;
+		if (ThrottledByteSource::IsThrottling(throttle) || ThrottledByteSource::GetEnvironmentSettings(throttle))
 		{
+			this->DataSource = CreateThrottledSource(this->DataSource, throttle);
+			this->DataSourceWrapsFile = true;
+		}
 
-			case VelocityFormat::Full:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesF32 = previousFrame->Meshes[iMesh].VelocitiesF32;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesF32 = (Vector3*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
+		// read through the local cache if requested. Without it, the file is read as it is.
+		if (!this->Options.CacheDirectory.empty())
+		{
+			std::shared_ptr<IByteSource> cachedFile = CreateCachedSource(this->DataSource, DiskCache::GetFileKey(this->InputFilePath), 
+				this->Options.CacheDirectory, this->Options.CacheSize);
 
-				break;
+			if (cachedFile != nullptr)
+			{
+				this->DataSource = cachedFile;
+				this->DataSourceWrapsFile = true;
 			}
+		}
+	}
 
-			case VelocityFormat::Half:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesI16 = previousFrame->Meshes[iMesh].VelocitiesI16;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesI16 = (int16*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
+	this->ReadPosition = 0;
 
-				break;
-			}
+	return true;
+}
 
-			case VelocityFormat::Byte:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesI8 = previousFrame->Meshes[iMesh].VelocitiesI8;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesI8 = (int8*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
 
-				break;
-			}
+//-----------------------------------------------------------------------------
+// Player::CloseInputFile
+//-----------------------------------------------------------------------------
+void Kimura::Player::CloseInputFile()
+{
+	// closes the file when this player opened it, and no one else reads through it
+	this->DataSource = nullptr;
+}
 
-			case VelocityFormat::None:
-			default:
-			{
-				break;
-			}			
 
+//-----------------------------------------------------------------------------
+// Player::ThreadExecute
+//-----------------------------------------------------------------------------
+void Kimura::Player::ThreadExecute()
+{
+	if (!this->Initialize())
+	{
+		return;
+	}
+
+	while (!this->StopThreadExecution)
+	{
+		if (!this->BufferNextFrame() && !this->LoadNextFrameImages() && !this->LoadNextPinnedFrame())
+		{
+			// when buffer is full or contains sufficient frames, pause the thread until there's something new to do
+			std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+			this->WakeUpBufferThreadEvent.wait(threadLock, [this]() { return this->BufferThreadWorkPending || this->StopThreadExecution; });
+			this->BufferThreadWorkPending = false;
+		}	
+	}
+
+	this->Shutdown();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Initialize
+//-----------------------------------------------------------------------------
+bool Kimura::Player::Initialize()
+{
+	if (!this->OpenInputFile())
+	{
+		this->AcceptFrameRequests(false);
+		return false;
+	}
+
+	// read the table of content from the file. The cursors of a clip take the one read by the clip.
+	{
+		if (this->Clip_ != nullptr)
+		{
+			this->AdoptTOC(this->Clip_->Source);
+		}
+		else if (!this->ReadTOC())
+		{
+			// failed
+			this->CloseInputFile();
+			this->AcceptFrameRequests(false);
+			return false;
+		}
+
+		// success! ready to start loading frames
+		this->Status = PlayerStatus::Ready;
+	}
+
+	// map the file if requested. Frames will then point directly into the mapping instead of their own buffer
+	if (this->ExternalReader != nullptr)
+	{
+		// the host reads the frames
+	}
+	else if (this->Clip_ != nullptr)
+	{
+		// mapped once by the clip, if at all
+		this->Mapping = this->Clip_->Mapping;
+	}
+	else if (this->DataSource->GetData() != nullptr)
+	{
+		// already in memory, treated just like a mapping
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (mapping->Open(this->DataSource))
+		{
+			this->Mapping = mapping;
+		}
+	}
+	else if (this->Options.MemoryMappedFile && !this->InputFilePath.empty() && !this->DataSourceWrapsFile)
+	{
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (mapping->Open(this->InputFilePath))
+		{
+			this->Mapping = mapping;
+		}
+	}
+
+	// hand the reads over to the host if requested
+	if (this->ExternalReader != nullptr)
+	{
+		this->Reader = this->ExternalReader;
+		this->MaxReadsInFlight = this->Options.ExternalReadQueueDepth;
+		this->ReadMethod = FrameReadMethod::External;
+	}
+
+	// keep multiple reads in flight if requested. Not needed when the file is mapped
+#if defined(KIMURA_IO_URING)
+	if (this->Reader == nullptr && this->Options.AsyncReadQueueDepth > 0 && this->Mapping == nullptr && !this->InputFilePath.empty() && 
+		!this->DataSourceWrapsFile)
+	{
+		AsyncFrameReader* asyncReader = new AsyncFrameReader(this, this->Options.AsyncReadQueueDepth);
+		if (asyncReader->Open(this->InputFilePath))
+		{
+			this->Reader = asyncReader;
+			this->MaxReadsInFlight = this->Options.AsyncReadQueueDepth;
+			this->ReadMethod = FrameReadMethod::IoUring;
+		}
+		else
+		{
+			// io_uring isn't available, fall back to the regular reads
+			delete asyncReader;
+		}
+	}
+#endif
+
+	// spread the reads over multiple threads if requested
+	if (this->Reader == nullptr && this->Options.NumReaderThreads > 0)
+	{
+		this->Reader = new FrameReaderPool(this, this->Options.NumReaderThreads);
+		this->MaxReadsInFlight = this->Options.NumReaderThreads;
+		this->ReadMethod = FrameReadMethod::Threads;
+	}
+
+	// frames read ahead are read by a thread of their own, the player's thread goes on resolving frames in the meantime
+	if (this->Reader == nullptr && this->Options.RawPreBufferingSize > 0 && !this->Options.BufferEntirePlayback)
+	{
+		this->Reader = new FrameReaderPool(this, 1);
+		this->MaxReadsInFlight = 1;
+		this->ReadMethod = FrameReadMethod::Threads;
+	}
+
+	// the reader threads only touch the pages of a mapping
+	if (this->Mapping != nullptr)
+	{
+		this->ReadMethod = FrameReadMethod::Mapped;
+	}
+
+	// adjust buffering sizes
+	if (this->Options.BufferEntirePlayback || this->Options.PreBufferingSize > this->TOC.NumFrames)
+	{
+		this->Options.PreBufferingSize = this->TOC.NumFrames;
+	}
+
+	{
+		std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+		this->Profiling.PreBufferingSize = this->Options.PreBufferingSize;
+		this->Profiling.ReadMethod = this->ReadMethod;
+	}
+
+	// the frames played first stay in memory, for playback to wrap around to them without waiting
+	if (this->Options.Loop && this->Options.PinLoopHead && !this->Options.BufferEntirePlayback && this->Options.PreBufferingSize > 0)
+	{
+		uint32 firstFrame = std::min(this->GetFrameAtPosition(0), this->GetFrameAtPosition(this->Options.PreBufferingSize - 1));
+
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		this->LoopHeadPins = { firstFrame, this->Options.PreBufferingSize, true, true };
+		this->PinRequests.push_back(this->LoopHeadPins);
+	}
+
+	// if any of the image sequences stored in the file is flagged as constant, we should read that frame and store it 
+	// immediately. 
+	bool bBufferFirstFrame = false;
+	for (const auto& imageSequence : this->TOC.ImageSequences)
+	{
+		if (imageSequence.Constant)
+		{
+			bBufferFirstFrame = true;
+			break;
+		}
+	}
+	if (bBufferFirstFrame)
+	{
+		this->LoadFrameAt(0, this->Selection);
+		this->FirstFrame = this->Frames[0];
+
+		// the constant images are needed right away
+		if (this->FirstFrame != nullptr && this->FirstFrame->ImagesPending)
+		{
+			this->LoadFrameImages(this->FirstFrame);
+		}
+	}
+
+	this->AcceptFrameRequests(true);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::AcceptFrameRequests
+//-----------------------------------------------------------------------------
+void Kimura::Player::AcceptFrameRequests(bool InInitialized)
+{
+	// the requests made while initializing are settled right away when out of range (or when initializing failed), 
+	// the others steer buffering like any request
+	std::vector<FrameRequest> rejectedRequests;
+	uint32 lastRequestedFrame = 0;
+	bool bFrameRequested = false;
+	{
+		std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+		this->FrameCountKnown = true;
+
+		uint32 numFrames = InInitialized ? (uint32)this->Frames.size() : 0;
+
+		std::vector<FrameRequest>::iterator it = this->FrameRequests.begin();
+		while (it != this->FrameRequests.end())
+		{
+			if (it->FrameIndex >= numFrames)
+			{
+				rejectedRequests.push_back(*it);
+				it = this->FrameRequests.erase(it);
+			}
+			else
+			{
+				lastRequestedFrame = it->FrameIndex;
+				bFrameRequested = true;
+				++it;
+			}
+		}
+	}
+
+	for (FrameRequest& request : rejectedRequests)
+	{
+		request.Callback(nullptr);
+	}
+
+	if (bFrameRequested)
+	{
+		this->MoveBufferingTo(lastRequestedFrame);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Shutdown
+//-----------------------------------------------------------------------------
+void Kimura::Player::Shutdown()
+{
+	// the host may still call into the external reader, it's deleted along with the player
+	if (this->Reader != nullptr && this->Reader != this->ExternalReader)
+	{
+		delete this->Reader;
+	}
+	this->Reader = nullptr;
+
+	// once no reader is left to read from it
+	this->CloseInputFile();
+
+	// frames still referencing the mapping will keep it alive
+	this->Mapping = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ExecuteScheduledWork
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ExecuteScheduledWork()
+{
+	// the shared scheduler's equivalent of a pass in the player's thread, returns whether there's more to do right away
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+		if (this->StopThreadExecution)
+		{
+			return false;
+		}
+	}
+
+	if (this->Status == PlayerStatus::Initializing)
+	{
+		return this->Initialize();
+	}
+
+	return this->BufferNextFrame() || this->LoadNextFrameImages() || this->LoadNextPinnedFrame();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Pump
+//-----------------------------------------------------------------------------
+bool Kimura::Player::Pump(double InTimeBudgetInMS)
+{
+	KIMURA_TRACE("Kimura::Player::Pump");
+
+	if (!this->Options.ManualPump)
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> pumpLock(this->PumpMutex, std::try_to_lock);
+	if (!pumpLock.owns_lock())
+	{
+		// already pumped by another thread. Work may well be left, the caller shouldn't take this as idle
+		return true;
+	}
+
+	// same slices as the shared scheduler: the table of content first, then a frame at a time
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + 
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(InTimeBudgetInMS));
+
+	do
+	{
+		if (!this->ExecuteScheduledWork())
+		{
+			return false;
+		}
+	} 
+	while (std::chrono::steady_clock::now() < deadline);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::TakeExternalReads
+//-----------------------------------------------------------------------------
+void Kimura::Player::TakeExternalReads(std::vector<ExternalRead>& OutReads)
+{
+	OutReads.clear();
+
+	if (this->ExternalReader != nullptr)
+	{
+		this->ExternalReader->TakeReads(OutReads);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::CompleteExternalRead
+//-----------------------------------------------------------------------------
+void Kimura::Player::CompleteExternalRead(uint64 InReadId, bool InSucceeded)
+{
+	if (this->ExternalReader != nullptr)
+	{
+		this->ExternalReader->CompleteRead(InReadId, InSucceeded);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetBufferDeadline
+//-----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point Kimura::Player::GetBufferDeadline()
+{
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	// when the buffered frames run out, if playback carries on at the file's frame rate
+	double bufferedTime = this->FullyBufferedFramesCount * (double)this->TOC.TimePerFrame;
+
+	std::chrono::steady_clock::time_point lastFrameRequestTime(std::chrono::steady_clock::duration(this->LastFrameRequestTime.load()));
+
+	return lastFrameRequestTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(bufferedTime));
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetNumPlaybackPositions
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetNumPlaybackPositions()
+{
+	uint32 numFrames = (uint32)this->Frames.size();
+
+	if (this->Options.Direction != PlaybackDirection::PingPong || numFrames < 2)
+	{
+		return numFrames;
+	}
+
+	// there and back again, the first and last frames aren't played twice in a row. Without looping, playback 
+	// ends on the first frame.
+	return this->Options.Loop ? 2 * (numFrames - 1) : 2 * numFrames - 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetFrameAtPosition
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetFrameAtPosition(uint32 InPosition)
+{
+	uint32 numFrames = (uint32)this->Frames.size();
+
+	if (numFrames == 0)
+	{
+		return 0;
+	}
+
+	switch (this->Options.Direction)
+	{
+		case PlaybackDirection::Reverse:
+			return numFrames - 1 - InPosition;
+
+		case PlaybackDirection::PingPong:
+			return InPosition < numFrames ? InPosition : 2 * (numFrames - 1) - InPosition;
+
+		default:
+			return InPosition;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetDistanceToFrame
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetDistanceToFrame(uint32 InPosition, uint32 iFrame)
+{
+	// number of positions from InPosition to the next one playing the frame. Without looping, the frames only played 
+	// before InPosition are out of reach.
+	uint32 numFrames = (uint32)this->Frames.size();
+	uint32 numPositions = this->GetNumPlaybackPositions();
+
+	if (numPositions == 0)
+	{
+		return 0;
+	}
+
+	uint32 distance = 0;
+
+	switch (this->Options.Direction)
+	{
+		case PlaybackDirection::Reverse:
+			distance = (numFrames - 1 - (iFrame % numFrames) + numPositions - InPosition) % numPositions;
+			break;
+
+		case PlaybackDirection::PingPong:
+		{
+			// on the way there, and again on the way back for the frames in between
+			distance = (iFrame + numPositions - InPosition) % numPositions;
+
+			uint32 positionOnTheWayBack = 2 * (numFrames - 1) - iFrame;
+			if (iFrame < numFrames && positionOnTheWayBack != iFrame && positionOnTheWayBack < numPositions)
+			{
+				distance = std::min(distance, (positionOnTheWayBack + numPositions - InPosition) % numPositions);
+			}
+			break;
+		}
+
+		default:
+			distance = (iFrame + numPositions - InPosition) % numPositions;
+			break;
+	}
+
+	if (!this->Options.Loop && distance >= numPositions - InPosition)
+	{
+		return FrameOutOfReach;
+	}
+
+	return distance;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::BufferNextFrame
+//-----------------------------------------------------------------------------
+bool Kimura::Player::BufferNextFrame()
+{
+	this->UpdatePreBufferingSize();
+
+	if (!this->ApplyMemoryBudget())
+	{
+		return false;
+	}
+
+	if (this->Reader != nullptr)
+	{
+		// reads are handed to the reader, frames are published as the reads complete. The frames read ahead are 
+		// resolved first, as playback makes room for them.
+		return this->ResolveRawFrames() || this->QueueNextFrameRead();
+	}
+
+	// find the index of the next frame to buffer
+	uint32 indexOfFrameToLoad = 0;	
+	uint32 positionToLoad = 0;
+	std::shared_ptr<Frame> sharedFrame = nullptr;
+	bool bDependenciesPlayedNext = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		this->ApplyFrameRequest();
+
+		if (this->FullyBufferedFramesCount >= this->Options.PreBufferingSize)
+		{
+			// sufficient number of frames are already buffered. There's no need to buffer another frame at this time. 
+			return false;
+		}
+
+		positionToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount;
+		
+		if (this->Options.Loop)
+		{
+			// wrap around
+			positionToLoad %= this->GetNumPlaybackPositions();
+		}
+		else if (positionToLoad >= this->GetNumPlaybackPositions())
+		{
+			// Reached the end of the playback. No more frames to buffer
+			return false;
+		}
+
+		indexOfFrameToLoad = this->GetFrameAtPosition(positionToLoad);
+
+		// frames still there from an earlier read, such as the dependencies read along with the frames after them when
+		// playing in reverse, are taken as they are
+		sharedFrame = this->Frames[indexOfFrameToLoad];
+		if (sharedFrame != nullptr && !FrameDataSelection::Same(sharedFrame->Selection, this->Selection))
+		{
+			sharedFrame = nullptr;
+		}
+
+		bDependenciesPlayedNext = indexOfFrameToLoad > 0 && this->GetDistanceToFrame(positionToLoad, indexOfFrameToLoad - 1) < this->Options.PreBufferingSize;
+	}
+
+	// so are the frames already resolved by another cursor of the clip, without their dependencies
+	if (sharedFrame == nullptr && this->Clip_ != nullptr)
+	{
+		sharedFrame = this->Clip_->FindFrame(indexOfFrameToLoad, this->Selection);
+	}
+
+	if (sharedFrame != nullptr)
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		this->StoreFrame(indexOfFrameToLoad, sharedFrame);
+	}
+	else
+	{
+		std::shared_ptr<const TOCFrameTable> page = this->AcquireTOCPage(indexOfFrameToLoad);
+		if (page == nullptr)
+		{
+			return false;
+		}
+
+		// get ref to previous frame. Frames read for the data a frame seeked to reuses don't count.
+		std::shared_ptr<Frame> previousFrame = nullptr;
+		{
+			std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+			previousFrame = indexOfFrameToLoad > 0 ? this->Frames[indexOfFrameToLoad - 1] : nullptr;
+
+			if (previousFrame != nullptr && !FrameDataSelection::Same(previousFrame->Selection, this->Selection))
+			{
+				previousFrame = nullptr;
+			}
+		}
+
+		// if previous frame is required but isn't loaded, we need to backtrack a bit
+		if (previousFrame == nullptr && page->DependsOnPreviousFrames(indexOfFrameToLoad))
+		{
+			if (bDependenciesPlayedNext)
+			{
+				for (uint32 i = page->GetFrameIndexDependency(indexOfFrameToLoad); i < indexOfFrameToLoad; i++)
+				{	
+					// load as many frames as needed. However!! These frames cannot be considered as fully loaded and 
+					// buffered (because their very own dependencies might not be met)
+					this->LoadFrameAt(i, this->Selection);
+				}
+			}
+			else
+			{
+				// frames played long after this one, or never, only have what this frame reuses read
+				uint32 firstDependency = 0;
+				std::vector<std::shared_ptr<const FrameDataSelection>> selections;
+
+				if (!this->SelectReusedData(indexOfFrameToLoad, firstDependency, selections))
+				{
+					return false;
+				}
+
+				for (uint32 i = firstDependency; i < indexOfFrameToLoad; i++)
+				{
+					this->LoadFrameAt(i, selections[i - firstDependency]);
+				}
+			}
+		}
+
+		this->LoadFrameAt(indexOfFrameToLoad, this->Selection);
+	}
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		uint32 positionWeReallyWantLoadedNext = (this->FullyBufferedFramesStart + FullyBufferedFramesCount ) % this->GetNumPlaybackPositions();
+
+		if (positionToLoad == positionWeReallyWantLoadedNext)
+		{
+			this->FullyBufferedFramesCount++;
+
+			std::atomic_store(&this->LatestFrame, this->Frames[indexOfFrameToLoad]);
+			this->PublishBufferedFrames();
+		}
+		else if (this->GetDistanceToFrame(this->FullyBufferedFramesStart, indexOfFrameToLoad) >= this->FullyBufferedFramesCount &&
+			!this->IsFramePinned(indexOfFrameToLoad))
+		{
+			this->StoreFrame(indexOfFrameToLoad, nullptr);
+		}
+	}
+
+	this->NotifyFrameBuffered();
+
+	return true;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::SelectReusedData
+//-----------------------------------------------------------------------------
+bool Kimura::Player::SelectReusedData(uint32 iFrame, uint32& OutFirstFrame, std::vector<std::shared_ptr<const FrameDataSelection>>& OutSelections)
+{
+	// the data of a frame seeked to reused from the frames before (seek of -1) is held by the last of them to have it. 
+	// Walking back from the frame, each frame is left with the data still reused at that point: the data it holds is 
+	// read, the rest is passed along from the frame before. Frames before the last one holding data aren't read at all.
+	const FrameDataSelection& selection = FrameDataSelection::Get(this->Selection);
+
+	uint32 numMeshes = (uint32)this->TOC.Meshes.size();
+	uint32 numImageSequences = (uint32)this->TOC.ImageSequences.size();
+
+	std::vector<uint32> attributes(numMeshes, 0);
+	std::vector<uint32> mipmaps(numImageSequences, 0);
+
+	int32 seeks[MeshAttribute_Count];
+	uint32 sizes[MeshAttribute_Count];
+
+	OutSelections.clear();
+	OutFirstFrame = iFrame;
+
+	uint32 firstDependency = iFrame;
+	bool bAnyReused = true;
+
+	for (uint32 i = iFrame; bAnyReused && i >= firstDependency && i <= iFrame; i--)
+	{
+		std::shared_ptr<const TOCFrameTable> page = this->AcquireTOCPage(i);
+		if (page == nullptr)
+		{
+			return false;
+		}
+
+		const TOCFrameTable& table = *page;
+		uint32 iFrameInPage = i - table.FirstFrame;
+
+		if (i == iFrame)
+		{
+			firstDependency = table.GetFrameIndexDependency(iFrame);
+		}
+		else
+		{
+			OutSelections.push_back(FrameDataSelection::CreateReused(this->Selection, attributes, mipmaps));
+			OutFirstFrame = i;
+		}
+
+		// what the frame reuses is still to be found further back. Meshes without an entry on the frame end the chain.
+		std::vector<uint32> reusedAttributes(numMeshes, 0);
+		bAnyReused = false;
+
+		for (uint32 iEntry = table.FirstMeshEntries[iFrameInPage]; iEntry < table.FirstMeshEntries[iFrameInPage + 1]; iEntry++)
+		{
+			uint32 iMesh = table.MeshIndices[iEntry];
+
+			table.GetAttributes(iEntry, seeks, sizes);
+
+			for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+			{
+				bool bNeeded = i == iFrame ? selection.Includes(iMesh, iAttribute) : (attributes[iMesh] & (1u << iAttribute)) != 0;
+
+				if (bNeeded && seeks[iAttribute] == -1)
+				{
+					reusedAttributes[iMesh] |= 1u << iAttribute;
+					bAnyReused = true;
+				}
+			}
+		}
+
+		attributes.swap(reusedAttributes);
+
+		uint32 iMipmapEntry = table.FirstMipmapEntries[iFrameInPage];
+
+		for (uint32 iImageSequence = 0; iImageSequence < numImageSequences; iImageSequence++)
+		{
+			uint32 numMipmaps = table.NumMipmaps[iFrameInPage * numImageSequences + iImageSequence];
+			uint32 reusedMipmaps = 0;
+
+			for (uint32 iMipmap = 0; iMipmap < numMipmaps; iMipmap++, iMipmapEntry++)
+			{
+				bool bNeeded = i == iFrame ? selection.IncludesMipmap(iImageSequence, iMipmap, numMipmaps) : (mipmaps[iImageSequence] & (1u << iMipmap)) != 0;
+
+				if (bNeeded && table.MipmapSeeks[iMipmapEntry] == -1)
+				{
+					reusedMipmaps |= 1u << iMipmap;
+					bAnyReused = true;
+				}
+			}
+
+			mipmaps[iImageSequence] = reusedMipmaps;
+		}
+	}
+
+	// in the order they're read
+	std::reverse(OutSelections.begin(), OutSelections.end());
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::QueueNextFrameRead
+//-----------------------------------------------------------------------------
+bool Kimura::Player::QueueNextFrameRead()
+{
+	// find the index of the next frame to read, right after the ones already buffered or being read
+	uint32 indexOfFrameToLoad = 0;
+	uint32 generation = 0;
+	bool bPreviousFrameAvailable = false;
+	bool bDependenciesPlayedNext = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		this->ApplyFrameRequest();
+
+		// frames backtracked to aren't buffered, they only take a read. Completed reads left to resolve aren't in flight.
+		uint32 numPendingReads = 0;
+		uint32 numReadsInFlight = 0;
+		for (const std::shared_ptr<FrameRead>& pendingRead : this->PendingReads)
+		{
+			if (!pendingRead->Dependency)
+			{
+				numPendingReads++;
+			}
+
+			if (!pendingRead->Completed)
+			{
+				numReadsInFlight++;
+			}
+		}
+
+		// frames are read further ahead than they're buffered, as long as they're played only once in the meantime
+		uint32 numFramesAhead = std::min(this->Options.PreBufferingSize + this->Options.RawPreBufferingSize, 
+			std::max(this->GetNumPlaybackPositions(), this->Options.PreBufferingSize));
+
+		if (this->FullyBufferedFramesCount + numPendingReads >= numFramesAhead)
+		{
+			// sufficient number of frames are buffered or on their way. 
+			return false;
+		}
+
+		if (numReadsInFlight >= this->MaxReadsInFlight)
+		{
+			// enough reads in flight, wait for one of them to complete
+			return false;
+		}
+
+		uint32 positionToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount + numPendingReads;
+
+		if (this->Options.Loop)
+		{
+			// wrap around
+			positionToLoad %= this->GetNumPlaybackPositions();
+		}
+		else if (positionToLoad >= this->GetNumPlaybackPositions())
+		{
+			// Reached the end of the playback. No more frames to buffer
+			return false;
+		}
+
+		indexOfFrameToLoad = this->GetFrameAtPosition(positionToLoad);
+
+		for (const std::shared_ptr<FrameRead>& pendingRead : this->PendingReads)
+		{
+			if (pendingRead->Dependency && pendingRead->Frame_->FrameIndex == indexOfFrameToLoad && 
+				FrameDataSelection::Same(pendingRead->Frame_->Selection, this->Selection))
+			{
+				// read as the dependency of a frame after it, when playing in reverse. Taken as it is once it's in.
+				return false;
+			}
+		}
+
+		// previous frame is either buffered or will be resolved right before this one. Frames read for the data a 
+		// frame seeked to reuses don't count.
+		const std::shared_ptr<Frame>& previousFrame = indexOfFrameToLoad > 0 ? this->Frames[indexOfFrameToLoad - 1] : nullptr;
+
+		bPreviousFrameAvailable = indexOfFrameToLoad > 0 && 
+			((!this->PendingReads.empty() && this->PendingReads.back()->Frame_->FrameIndex == indexOfFrameToLoad - 1) || 
+			 (previousFrame != nullptr && FrameDataSelection::Same(previousFrame->Selection, this->Selection)));
+
+		bDependenciesPlayedNext = indexOfFrameToLoad > 0 && this->GetDistanceToFrame(positionToLoad, indexOfFrameToLoad - 1) < this->Options.PreBufferingSize;
+
+		generation = this->ReadGeneration;
+	}
+
+	std::shared_ptr<FrameRead> read = this->CreateFrameRead(indexOfFrameToLoad, generation, this->Selection);
+	if (read == nullptr)
+	{
+		return false;
+	}
+
+	// if previous frame is required but isn't loaded, we need to backtrack a bit. The frames it depends on are read
+	// along with it and resolved right before it. Unless they're played right after it, only for what it reuses.
+	std::vector<std::shared_ptr<FrameRead>> reads;
+
+	if (!read->Shared && !bPreviousFrameAvailable && read->Frame_->TOCPage->DependsOnPreviousFrames(indexOfFrameToLoad))
+	{
+		uint32 firstDependency = read->Frame_->TOCPage->GetFrameIndexDependency(indexOfFrameToLoad);
+		std::vector<std::shared_ptr<const FrameDataSelection>> selections;
+
+		if (bDependenciesPlayedNext)
+		{
+			selections.assign(indexOfFrameToLoad - firstDependency, this->Selection);
+		}
+		else if (!this->SelectReusedData(indexOfFrameToLoad, firstDependency, selections))
+		{
+			return false;
+		}
+
+		for (uint32 i = firstDependency; i < indexOfFrameToLoad; i++)
+		{
+			std::shared_ptr<FrameRead> dependencyRead = this->CreateFrameRead(i, generation, selections[i - firstDependency]);
+			if (dependencyRead == nullptr)
+			{
+				return false;
+			}
+
+			dependencyRead->Dependency = true;
+			reads.push_back(dependencyRead);
+		}
+	}
+
+	reads.push_back(read);
+
+	bool bAnyCompleted = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		if (generation != this->ReadGeneration)
+		{
+			// playback jumped elsewhere in the meantime. Start over.
+			return true;
+		}
+
+		for (const std::shared_ptr<FrameRead>& queuedRead : reads)
+		{
+			this->PendingReads.push_back(queuedRead);
+			bAnyCompleted |= queuedRead->Completed;
+		}
+	}
+
+	for (const std::shared_ptr<FrameRead>& queuedRead : reads)
+	{
+		if (!queuedRead->Completed)
+		{
+			this->Reader->Queue(queuedRead);
+		}
+	}
+
+	if (bAnyCompleted)
+	{
+		this->PublishCompletedReads();
+	}
+
+	return true;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::CreateFrameRead
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::FrameRead> Kimura::Player::CreateFrameRead(uint32 iFrame, uint32 InGeneration, const std::shared_ptr<const FrameDataSelection>& InSelection)
+{
+	std::shared_ptr<FrameRead> read = std::make_shared<FrameRead>();
+	read->Generation = InGeneration;
+
+	// frames still there from an earlier read, or already resolved by another cursor of the clip, don't need to be 
+	// read. They still go through the pending reads, to be published in order. Frames loaded with the player's 
+	// selection also hold the data reused by the frames after them.
+	std::shared_ptr<Frame> sharedFrame = std::atomic_load(&this->Frames[iFrame]);
+
+	if (sharedFrame != nullptr && !FrameDataSelection::Same(sharedFrame->Selection, InSelection) && 
+		!FrameDataSelection::Same(sharedFrame->Selection, this->Selection))
+	{
+		sharedFrame = nullptr;
+	}
+
+	if (sharedFrame == nullptr && this->Clip_ != nullptr)
+	{
+		sharedFrame = this->Clip_->FindFrame(iFrame, this->Selection);
+	}
+
+	if (sharedFrame != nullptr)
+	{
+		read->Frame_ = sharedFrame;
+		read->Shared = true;
+		read->Completed = true;
+		return read;
+	}
+
+	std::shared_ptr<const TOCFrameTable> page = this->AcquireTOCPage(iFrame);
+	if (page == nullptr)
+	{
+		return nullptr;
+	}
+
+	read->Frame_ = this->Pool->AcquireFrame();
+	read->Frame_->FrameIndex = iFrame;
+	read->Frame_->TOCPage = page;
+	read->Frame_->Selection = InSelection;
+
+	if (FrameDataSelection::Get(InSelection).ReusedDataOnly)
+	{
+		// frames only passing along what the frame seeked to reuses from the frames before have nothing to read, 
+		// they're only resolved
+		std::vector<FrameDataRange> ranges;
+		InSelection->GatherRanges(*page, iFrame, ranges);
+
+		read->Completed = ranges.empty();
+	}
+
+	return read;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ExecuteFrameRead
+//-----------------------------------------------------------------------------
+void Kimura::Player::ExecuteFrameRead(std::shared_ptr<FrameRead> InRead)
+{
+	KIMURA_TRACE("Kimura::Player::ExecuteFrameRead");
+
+	// reads made obsolete by a jump elsewhere in the playback don't need to reach the disk
+	if (!this->IsFrameReadCurrent(*InRead))
+	{
+		return;
+	}
+
+	if (!this->ReadFrameData(*InRead->Frame_))
+	{
+		return;
+	}
+
+	this->CompleteFrameRead(InRead);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsFrameReadCurrent
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsFrameReadCurrent(const FrameRead& InRead)
+{
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+	return InRead.Generation == this->ReadGeneration;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::CompleteFrameRead
+//-----------------------------------------------------------------------------
+void Kimura::Player::CompleteFrameRead(std::shared_ptr<FrameRead> InRead)
+{
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		InRead->Completed = true;
+	}
+
+	this->PublishCompletedReads();
+
+	// one less read in flight, the player's thread can queue another one
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PublishCompletedReads
+//-----------------------------------------------------------------------------
+void Kimura::Player::PublishCompletedReads()
+{
+	bool bPublished = false;
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// frames are resolved in order, by one reader at a time. If another reader is already at it, it will 
+		// pick up our completed read as well.
+		if (this->ResolvingReads)
+		{
+			return;
+		}
+
+		this->ResolvingReads = true;
+
+		// past PreBufferingSize frames, the frames read ahead are left as they are until playback makes room for them
+		while (!this->PendingReads.empty() && this->PendingReads.front()->Completed && 
+			this->FullyBufferedFramesCount < this->Options.PreBufferingSize)
+		{
+			std::shared_ptr<FrameRead> read = this->PendingReads.front();
+
+			threadLock.unlock();
+			if (!read->Shared)
+			{
+				this->ResolveFrame(*read->Frame_);
+
+				// another cursor of the clip might have resolved the same frame in the meantime, only one is kept. Frames
+				// holding only some of the data of another frame stay with this player.
+				if (this->Clip_ != nullptr && !FrameDataSelection::Get(read->Frame_->Selection).ReusedDataOnly)
+				{
+					read->Frame_ = this->Clip_->ShareFrame(read->Frame_);
+				}
+			}
+			threadLock.lock();
+
+			if (read->Generation != this->ReadGeneration)
+			{
+				// playback jumped elsewhere while resolving, the pending reads were discarded
+				continue;
+			}
+
+			this->PendingReads.pop_front();
+
+			if (read->Dependency)
+			{
+				// only there for the frames after it to be resolved. A frame loaded with the player's selection in the
+				// meantime, such as a pinned frame, does just as well.
+				const std::shared_ptr<Frame>& frame = this->Frames[read->Frame_->FrameIndex];
+				if (frame == nullptr || !FrameDataSelection::Same(frame->Selection, this->Selection))
+				{
+					this->StoreFrame(read->Frame_->FrameIndex, read->Frame_);
+				}
+				continue;
+			}
+
+			uint32 indexOfFrameWeReallyWantLoadedNext = this->GetFrameAtPosition((this->FullyBufferedFramesStart + this->FullyBufferedFramesCount) % this->GetNumPlaybackPositions());
+			if (read->Frame_->FrameIndex == indexOfFrameWeReallyWantLoadedNext)
+			{
+				this->StoreFrame(read->Frame_->FrameIndex, read->Frame_);
+				this->FullyBufferedFramesCount++;
+
+				std::atomic_store(&this->LatestFrame, read->Frame_);
+				this->PublishBufferedFrames();
+
+				bPublished = true;
+			}
+		}
+
+		this->ResolvingReads = false;
+	}
+
+	if (bPublished)
+	{
+		this->NotifyFrameBuffered();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ResolveRawFrames
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ResolveRawFrames()
+{
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		this->ApplyFrameRequest();
+
+		// nothing read ahead, no room for it yet, or another reader is already resolving it
+		if (this->PendingReads.empty() || !this->PendingReads.front()->Completed || this->ResolvingReads ||
+			this->FullyBufferedFramesCount >= this->Options.PreBufferingSize)
+		{
+			return false;
+		}
+	}
+
+	this->PublishCompletedReads();
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::NotifyFrameBuffered
+//-----------------------------------------------------------------------------
+void Kimura::Player::NotifyFrameBuffered()
+{
+	{
+		// notify while holding the mutex so that a waiter checking for its frame can't miss it
+		std::unique_lock<std::mutex> waitLock(this->WaitForFrameBufferedMutex);
+		this->WaitForFrameBufferedEvent.notify_all();
+	}
+
+	this->CompleteFrameRequests();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadFrameAt
+//-----------------------------------------------------------------------------
+void Kimura::Player::LoadFrameAt(uint32 iFrame, const std::shared_ptr<const FrameDataSelection>& InSelection)
+{
+	KIMURA_TRACE("Kimura::Player::LoadFrameAt");
+
+	// frames still there from an earlier read are kept. Frames loaded with the player's selection also hold the data 
+	// reused by the frames after them.
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		const std::shared_ptr<Frame>& frame = this->Frames[iFrame];
+		if (frame != nullptr && (FrameDataSelection::Same(frame->Selection, InSelection) || FrameDataSelection::Same(frame->Selection, this->Selection)))
+		{
+			return;
+		}
+	}
+
+	// frames already resolved by another cursor of the clip are shared as they are
+	std::shared_ptr<Frame> newFrame = this->Clip_ != nullptr ? this->Clip_->FindFrame(iFrame, this->Selection) : nullptr;
+
+	if (newFrame == nullptr)
+	{
+		newFrame = this->Pool->AcquireFrame();
+		newFrame->FrameIndex = iFrame;
+		newFrame->TOCPage = this->AcquireTOCPage(iFrame);
+		newFrame->Selection = InSelection;
+
+		if (newFrame->TOCPage == nullptr)
+		{
+			return;
+		}
+
+		if (!this->ReadFrameData(*newFrame))
+		{
+			return;
+		}
+
+		this->ResolveFrame(*newFrame);
+
+		// the frames holding only some of the data of another frame stay with this player
+		if (this->Clip_ != nullptr && !FrameDataSelection::Get(InSelection).ReusedDataOnly)
+		{
+			newFrame = this->Clip_->ShareFrame(newFrame);
+		}
+	}
+
+	// store the frame, unless a frame with the player's selection got there in the meantime, such as a pinned frame
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		const std::shared_ptr<Frame>& frame = this->Frames[iFrame];
+		if (frame == nullptr || !FrameDataSelection::Same(frame->Selection, this->Selection))
+		{
+			this->StoreFrame(iFrame, newFrame);
+		}
+	}
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReadFrameData
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ReadFrameData(Frame& InOutFrame)
+{
+	KIMURA_TRACE("Kimura::Player::ReadFrameData");
+
+	const TOCFrameTable& table = *InOutFrame.TOCPage;
+	uint64 positionOfFrameInFile = this->FrameDataFilePosition + table.FilePositions[InOutFrame.FrameIndex - table.FirstFrame];
+	uint64 sizeOfFrame = table.BufferSizes[InOutFrame.FrameIndex - table.FirstFrame];
+
+	ScopedTime s;
+
+	uint64 bytesRead = sizeOfFrame;
+
+	if (this->Mapping != nullptr)
+	{
+		KIMURA_TRACE("Kimura::Player::ReadFrameData::touch");
+
+		if (positionOfFrameInFile + sizeOfFrame > this->Mapping->Size)
+		{
+			this->Failure("Frame data lies outside of the mapped file");
+			return false;
+		}
+
+		// no copy, the frame simply points into the mapping. Page it in now rather than on first access by the user.
+		InOutFrame.Mapping = this->Mapping;
+
+		if (InOutFrame.Selection == nullptr)
+		{
+			this->Mapping->Touch(positionOfFrameInFile, sizeOfFrame);
+		}
+		else
+		{
+			// only the data of the meshes and attributes loaded is paged in
+			std::vector<FrameDataRange> ranges;
+			InOutFrame.Selection->GatherRanges(table, InOutFrame.FrameIndex, ranges);
+
+			bytesRead = 0;
+			for (const FrameDataRange& range : ranges)
+			{
+				this->Mapping->Touch(positionOfFrameInFile + range.Offset, range.Size);
+				bytesRead += range.Size;
+			}
+		}
+
+		InOutFrame.FrameData = this->Mapping->Data + positionOfFrameInFile;
+	}
+	else if (InOutFrame.Selection != nullptr)
+	{
+		KIMURA_TRACE("Kimura::Player::ReadFrameData::scatter");
+
+		// only the data of the meshes and attributes loaded is read, one read per range, back to back in the buffer
+		InOutFrame.Selection->GatherRanges(table, InOutFrame.FrameIndex, InOutFrame.DataRanges);
+
+		uint64 sizeOfRanges = 0;
+		if (!InOutFrame.DataRanges.empty())
+		{
+			sizeOfRanges = InOutFrame.DataRanges.back().BufferOffset + InOutFrame.DataRanges.back().Size;
+		}
+
+		InOutFrame.FrameData = this->Pool->PrepareBuffer(InOutFrame, sizeOfRanges);
+		if (InOutFrame.FrameData == nullptr && sizeOfRanges > 0)
+		{
+			this->Failure("Failed to allocate frame buffer");
+			return false;
+		}
+
+		// low priority images have room in the buffer but are read later, see LoadFrameImages
+		InOutFrame.ImagesPending = InOutFrame.Selection->DeferImages && !this->TOC.ImageSequences.empty();
+
+		bytesRead = 0;
+		for (const FrameDataRange& range : InOutFrame.DataRanges)
+		{
+			if (range.Image && InOutFrame.ImagesPending)
+			{
+				continue;
+			}
+
+			if (!this->DataSource->ReadAt(positionOfFrameInFile + range.Offset, InOutFrame.Buffer + range.BufferOffset, range.Size))
+			{
+				this->Failure("Failed to read frame data from file");
+				return false;
+			}
+
+			bytesRead += range.Size;
+		}
+	}
+	else
+	{
+		// get a buffer large enough to contain the entire frame
+		byte* frameData = this->PrepareFrameBuffer(InOutFrame, positionOfFrameInFile, sizeOfFrame);
+		if (frameData == nullptr && sizeOfFrame > 0)
+		{
+			this->Failure("Failed to allocate frame buffer");
+			return false;
+		}
+
+		KIMURA_TRACE("Kimura::Player::ReadFrameData::read");
+
+		// positional read, doesn't disturb any other reader
+		if (!this->DataSource->ReadAt(positionOfFrameInFile, frameData, sizeOfFrame))
+		{
+			this->Failure("Failed to read frame data from file");
+			return false;
+		}
+	}
+
+	this->RecordFrameRead(bytesRead, s.Duration());
+
+	return true;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PrepareFrameBuffer
+//-----------------------------------------------------------------------------
+Kimura::byte* Kimura::Player::PrepareFrameBuffer(Frame& InOutFrame, uint64& OutPosition, uint64& OutSize)
+{
+	const TOCFrameTable& table = *InOutFrame.TOCPage;
+	OutPosition = this->FrameDataFilePosition + table.FilePositions[InOutFrame.FrameIndex - table.FirstFrame];
+	OutSize = table.BufferSizes[InOutFrame.FrameIndex - table.FirstFrame];
+
+	// only some meshes or attributes loaded. Still a single read, of the part of the frame spanning the data needed
+	if (InOutFrame.Selection != nullptr)
+	{
+		InOutFrame.Selection->GatherRanges(table, InOutFrame.FrameIndex, InOutFrame.DataRanges);
+
+		FrameDataRange span;
+		if (!InOutFrame.DataRanges.empty())
+		{
+			span.Offset = InOutFrame.DataRanges.front().Offset & ~(FrameDataRangeAlignment - 1);
+			span.Size = InOutFrame.DataRanges.back().Offset + InOutFrame.DataRanges.back().Size - span.Offset;
+		}
+
+		InOutFrame.DataRanges.assign(1, span);
+
+		OutPosition += span.Offset;
+		OutSize = span.Size;
+	}
+
+	InOutFrame.FrameData = this->Pool->PrepareBuffer(InOutFrame, OutSize);
+
+	return InOutFrame.Buffer;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RecordFrameRead
+//-----------------------------------------------------------------------------
+void Kimura::Player::RecordFrameRead(uint64 InBytesRead, double InDuration)
+{
+	std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+
+	this->Profiling.BytesReadInLastSecond += InBytesRead;
+	this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond += InDuration;
+
+	// the first read sets the averages
+	double weight = this->AverageReadTime > 0.0 ? MovingAverageWeight : 1.0;
+	this->AverageReadSize += ((double)InBytesRead - this->AverageReadSize) * weight;
+	this->AverageReadTime += (InDuration - this->AverageReadTime) * weight;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::UpdatePreBufferingSize
+//-----------------------------------------------------------------------------
+void Kimura::Player::UpdatePreBufferingSize()
+{
+	if (!this->Options.AdaptivePreBuffering || this->Options.BufferEntirePlayback)
+	{
+		return;
+	}
+
+	// nothing to go by until the first frames are loaded
+	double averageReadSize = 0.0;
+	double averageReadTime = 0.0;
+	double averageProcessingTime = 0.0;
+	{
+		std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+
+		averageReadSize = this->AverageReadSize;
+		averageReadTime = this->AverageReadTime;
+		averageProcessingTime = this->AverageProcessingTime;
+	}
+
+	if (averageReadSize <= 0.0 || averageReadTime <= 0.0)
+	{
+		return;
+	}
+
+	double bandwidth = averageReadSize / averageReadTime;
+	double frameTime = 1.0 / (this->TOC.FrameRate > 0.0f ? this->TOC.FrameRate : 30.0);
+
+	uint32 numPositions = this->GetNumPlaybackPositions();
+	uint32 firstPosition = 0;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		firstPosition = this->FullyBufferedFramesStart;
+	}
+
+	uint32 numFramesAhead = std::min((uint32)std::ceil(this->Options.PreBufferingLookAhead / frameTime), numPositions);
+	if (!this->Options.Loop)
+	{
+		numFramesAhead = std::min(numFramesAhead, numPositions - std::min(firstPosition, numPositions));
+	}
+
+	// size of the frames ahead, from the pages of the table of content at hand. The others are taken to be average.
+	std::vector<double>& frameSizes = this->FrameSizesAhead;
+	frameSizes.assign(numFramesAhead, averageReadSize);
+	{
+		std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+
+		for (uint32 i = 0; i < numFramesAhead; i++)
+		{
+			uint32 iFrame = this->GetFrameAtPosition((firstPosition + i) % numPositions);
+
+			const std::shared_ptr<TOCFrameTable>& page = this->TOCPages[iFrame / this->FramesPerTOCPage];
+			if (page != nullptr)
+			{
+				frameSizes[i] = (double)page->BufferSizes[iFrame - page->FirstFrame];
+			}
+		}
+	}
+
+	// how far ahead of playback loading must be when getting to each frame, worked out backwards: the frames taking 
+	// longer to load than to play add to it, the others make up for it. Reads in flight overlap each other and the 
+	// processing of the frames before them.
+	double timeAhead = 0.0;
+	double maxTimeAhead = 0.0;
+	for (uint32 i = numFramesAhead; i-- > 0;)
+	{
+		double readTime = frameSizes[i] / bandwidth;
+		double loadTime = this->Reader != nullptr ? std::max(readTime / std::max(this->MaxReadsInFlight, 1u), averageProcessingTime) : readTime + averageProcessingTime;
+
+		timeAhead = std::max(timeAhead + loadTime - frameTime, 0.0);
+		maxTimeAhead = std::max(maxTimeAhead, timeAhead);
+	}
+
+	uint32 preBufferingSize = (uint32)std::ceil((maxTimeAhead + this->Options.PreBufferingMargin) / frameTime);
+	preBufferingSize = std::max(std::min(preBufferingSize, this->TOC.NumFrames), 1u);
+
+	// within the memory allowed, at least one frame
+	double memoryUsage = 0.0;
+	for (uint32 i = 0; i < preBufferingSize; i++)
+	{
+		memoryUsage += i < numFramesAhead ? frameSizes[i] : averageReadSize;
+		if (memoryUsage > (double)this->Options.PreBufferingMemory && i > 0)
+		{
+			preBufferingSize = i;
+			break;
+		}
+	}
+
+	uint32 previousPreBufferingSize = 0;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		previousPreBufferingSize = this->Options.PreBufferingSize;
+		this->Options.PreBufferingSize = preBufferingSize;
+	}
+
+	// the frames kept for reuse follow the size of the window. The pool of a clip is sized by the clip.
+	if (preBufferingSize != previousPreBufferingSize && this->Clip_ == nullptr)
+	{
+		this->Pool->SetMaxFreeFrames(this->Options.BackBufferSize + preBufferingSize + 1);
+	}
+
+	{
+		std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+		this->Profiling.PreBufferingSize = preBufferingSize;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ResolveFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::ResolveFrame(Frame& InOutFrame)
+{
+	KIMURA_TRACE("Kimura::Player::ResolveFrame");
+
+	uint32 iFrame = InOutFrame.FrameIndex;
+
+	// the frame's page of the table of content is only needed until the frame is resolved
+	const TOCFrameTable& table = *InOutFrame.TOCPage;
+	uint32 iFrameInPage = iFrame - table.FirstFrame;
+
+	std::shared_ptr<Frame> previousFrame = nullptr;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// get ref to previous frame (if any or necessary). Data reused from earlier frames is reached through it.
+		previousFrame = iFrame > 0 ? this->Frames[iFrame - 1] : nullptr;
+	}
+
+	// allocate mesh instances for this frame. Meshes without an entry are empty on this frame
+	InOutFrame.Meshes.resize(this->TOC.Meshes.size());
+
+	ScopedTime timeProcessingFrame;
+
+	const byte* bufferAddress = InOutFrame.FrameData;
+
+	int32 seeks[MeshAttribute_Count];
+	uint32 sizes[MeshAttribute_Count];
+
+	for (uint32 iEntry = table.FirstMeshEntries[iFrameInPage]; iEntry < table.FirstMeshEntries[iFrameInPage + 1]; iEntry++)
+	{
+		uint32 iMesh = table.MeshIndices[iEntry];
+
+		FrameMesh& frameMesh = InOutFrame.Meshes[iMesh];
+
+		TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
+
+		table.GetAttributes(iEntry, seeks, sizes);
+
+		// attributes not loaded have no data, the ones loaded are located in the frame's buffer
+		if (InOutFrame.Selection != nullptr)
+		{
+			for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+			{
+				if (!InOutFrame.Selection->Includes(iMesh, iAttribute))
+				{
+					seeks[iAttribute] = 0;
+					sizes[iAttribute] = 0;
+				}
+				else if (seeks[iAttribute] != -1 && sizes[iAttribute] > 0)
+				{
+					seeks[iAttribute] = (int32)InOutFrame.GetBufferOffset((uint32)seeks[iAttribute]);
+				}
+			}
+		}
+
+		frameMesh.Vertices = table.Vertices[iEntry];
+		frameMesh.Surfaces = table.Surfaces[iEntry];
+
+		// a simple copy of the frame mesh's sections
+		const TOCFrameMeshSection* sections = table.Sections.data() + table.FirstSections[iEntry];
+		frameMesh.Sections.assign(sections, sections + table.NumSections[iEntry]);
+
+		frameMesh.PositionQuantizationCenter = table.PositionQuantizationCenters[iEntry];
+		frameMesh.PositionQuantizationExtents = table.PositionQuantizationExtents[iEntry];
+
+		frameMesh.VelocityQuantizationCenter = table.VelocityQuantizationCenters[iEntry];
+		frameMesh.VelocityQuantizationExtents = table.VelocityQuantizationExtents[iEntry];
+
+		frameMesh.ColorQuantizationExtents[0] = table.ColorQuantizationExtents[iEntry * MaxColorChannels];
+		frameMesh.ColorQuantizationExtents[1] = table.ColorQuantizationExtents[iEntry * MaxColorChannels + 1];
+
+		// copy bounds info
+		frameMesh.BoundingCenter = table.BoundingCenters[iEntry];
+		frameMesh.BoundingSize = table.BoundingSizes[iEntry];
+
+		// number of vertices stored in this frame determines the type of index buffer used
+		if (frameMesh.Vertices <= 0xfffe || this->TOC.Force16BitIndices)
+		{
+			// 16bit indices
+
+			if (seeks[MeshAttribute_Indices] == -1)
+			{
+				// re-use previous frame's indices
+				if (previousFrame != nullptr)
+				{
+					frameMesh.IndicesU16 = previousFrame->Meshes[iMesh].IndicesU16;
+				}
+			}
+			else if (sizes[MeshAttribute_Indices] > 0)
+			{
+				frameMesh.IndicesU16 = (uint16*)&bufferAddress[seeks[MeshAttribute_Indices]];
+			}
+		}
+		else
+		{
+			// 32bit indices
+
+			if (seeks[MeshAttribute_Indices] == -1)
+			{
+				// re-use previous frame's indices
+				if (previousFrame != nullptr)
+				{
+					frameMesh.IndicesU32 = previousFrame->Meshes[iMesh].IndicesU32;
+				}
+			}
+			else if (sizes[MeshAttribute_Indices] > 0)
+			{
+				frameMesh.IndicesU32 = (uint32*)&bufferAddress[seeks[MeshAttribute_Indices]];
+			}
+		}
+
+		// position
+		switch (tocMesh.PositionFormat_)
+		{
+			case PositionFormat::Full:
+			{
+				if (seeks[MeshAttribute_Positions] == -1)
+				{
+					// re-use previous frame's positions
+					if (previousFrame != nullptr)
+					{
+						frameMesh.PositionsF32 = previousFrame->Meshes[iMesh].PositionsF32;
+					}
+				}
+				else if (sizes[MeshAttribute_Positions] > 0)
+				{
+					frameMesh.PositionsF32 = (Vector3*) &bufferAddress[seeks[MeshAttribute_Positions]];
+				}
+
+				break;
+
+			}
+
+			case PositionFormat::Half:
+			{				
+				if (seeks[MeshAttribute_Positions] == -1)
+				{
+					// re-use previous frame's positions
+					if (previousFrame != nullptr)
+					{
+						frameMesh.PositionsI16 = previousFrame->Meshes[iMesh].PositionsI16;
+					}
+				}
+				else if (sizes[MeshAttribute_Positions] > 0)
+				{
+					frameMesh.PositionsI16 = (int16*)&bufferAddress[seeks[MeshAttribute_Positions]];
+				}
+
+				break;
+			}
+		}
+
+		// normal
+		switch (tocMesh.NormalFormat_)
+		{
+			case NormalFormat::Full:
+			{
+				if (seeks[MeshAttribute_Normals] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.NormalsF32 = previousFrame->Meshes[iMesh].NormalsF32;
+					}
+				}
+				else if (sizes[MeshAttribute_Normals] > 0)
+				{
+					frameMesh.NormalsF32 = (Vector3*) &bufferAddress[seeks[MeshAttribute_Normals]];
+				}
+
+				break;
+			}
+
+			case NormalFormat::Half:
+			{
+				if (seeks[MeshAttribute_Normals] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.NormalsI16 = previousFrame->Meshes[iMesh].NormalsI16;
+					}
+				}
+				else if (sizes[MeshAttribute_Normals] > 0)
+				{
+					frameMesh.NormalsI16 = (int16*)&bufferAddress[seeks[MeshAttribute_Normals]];
+				}
+
+				break;
+			}
+
+			case NormalFormat::Byte:
+			{
+				if (seeks[MeshAttribute_Normals] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.NormalsI8 = previousFrame->Meshes[iMesh].NormalsI8;
+					}
+				}
+				else if (sizes[MeshAttribute_Normals] > 0)
+				{
+					frameMesh.NormalsI8 = (int8*)&bufferAddress[seeks[MeshAttribute_Normals]];
+				}
+
+				break;
+			}
+
+			case NormalFormat::None:
+			default:
+			{
+				break;
+			}
+
+		}
+
+
+		// Tangent
+		switch (tocMesh.TangentFormat_)
+		{
+			case TangentFormat::Full:
+			{
+				if (seeks[MeshAttribute_Tangents] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.TangentsF32 = previousFrame->Meshes[iMesh].TangentsF32;
+					}
+				}
+				else if (sizes[MeshAttribute_Tangents] > 0)
+				{
+					frameMesh.TangentsF32 = (Vector4*) &bufferAddress[seeks[MeshAttribute_Tangents]];
+				}
+
+				break;
+			}
+
+			case TangentFormat::Half:
+			{
+				if (seeks[MeshAttribute_Tangents] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.TangentsI16 = previousFrame->Meshes[iMesh].TangentsI16;
+					}
+				}
+				else if (sizes[MeshAttribute_Tangents] > 0)
+				{
+					frameMesh.TangentsI16 = (int16*)&bufferAddress[seeks[MeshAttribute_Tangents]];
+				}
+
+				break;
+			}
+
+			case TangentFormat::Byte:
+			{
+				if (seeks[MeshAttribute_Tangents] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.TangentsI8 = previousFrame->Meshes[iMesh].TangentsI8;
+					}
+				}
+				else if (sizes[MeshAttribute_Tangents] > 0)
+				{
+					frameMesh.TangentsI8 = (int8*)&bufferAddress[seeks[MeshAttribute_Tangents]];
+				}
+
+				break;
+			}
+
+			case TangentFormat::None:
+			default:
+			{
+				break;
+			}
+
+		}
+
+
+
+		// velocity
+		switch (tocMesh.VelocityFormat_)
+		{
+
+			case VelocityFormat::Full:
+			{
+				if (seeks[MeshAttribute_Velocities] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.VelocitiesF32 = previousFrame->Meshes[iMesh].VelocitiesF32;
+					}
+				}
+				else if (sizes[MeshAttribute_Velocities] > 0)
+				{
+					frameMesh.VelocitiesF32 = (Vector3*)&bufferAddress[seeks[MeshAttribute_Velocities]];
+				}
+
+				break;
+			}
+
+			case VelocityFormat::Half:
+			{
+				if (seeks[MeshAttribute_Velocities] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.VelocitiesI16 = previousFrame->Meshes[iMesh].VelocitiesI16;
+					}
+				}
+				else if (sizes[MeshAttribute_Velocities] > 0)
+				{
+					frameMesh.VelocitiesI16 = (int16*)&bufferAddress[seeks[MeshAttribute_Velocities]];
+				}
+
+				break;
+			}
+
+			case VelocityFormat::Byte:
+			{
+				if (seeks[MeshAttribute_Velocities] == -1)
+				{
+					if (previousFrame != nullptr)
+					{
+						frameMesh.VelocitiesI8 = previousFrame->Meshes[iMesh].VelocitiesI8;
+					}
+				}
+				else if (sizes[MeshAttribute_Velocities] > 0)
+				{
+					frameMesh.VelocitiesI8 = (int8*)&bufferAddress[seeks[MeshAttribute_Velocities]];
+				}
+
+				break;
+			}
+
+			case VelocityFormat::None:
+			default:
+			{
+				break;
+			}			
+
+		}
+
+		// texture coords
+		switch (tocMesh.TexCoordFormat_)
+		{
+			case TexCoordFormat::Full:
+			{
+				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
+				{
+					if (seeks[MeshAttribute_TexCoords + iTC] == -1)
+					{
+						if (previousFrame != nullptr)
+						{
+							frameMesh.TexCoordsF32[iTC] = previousFrame->Meshes[iMesh].TexCoordsF32[iTC];
+						}
+					}
+					else if (sizes[MeshAttribute_TexCoords + iTC] > 0)
+					{
+						frameMesh.TexCoordsF32[iTC] = (float*)&bufferAddress[seeks[MeshAttribute_TexCoords + iTC]];
+					}
+				}
+
+				break;
+			}
+
+			case TexCoordFormat::Half:
+			{
+				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
+				{
+					if (seeks[MeshAttribute_TexCoords + iTC] == -1)
+					{
+						if (previousFrame != nullptr)
+						{
+							frameMesh.TexCoordsU16[iTC] = previousFrame->Meshes[iMesh].TexCoordsU16[iTC];
+						}
+					}
+					else if (sizes[MeshAttribute_TexCoords + iTC] > 0)
+					{
+						frameMesh.TexCoordsU16[iTC] = (uint16*)&bufferAddress[seeks[MeshAttribute_TexCoords + iTC]];
+					}
+				}
+
+				break;
+			}
+
+			case TexCoordFormat::None:
+			default:
+			{
+				break;
+			}			
+
+		}
+
+
+		switch (tocMesh.ColorFormat_)
+		{
+			case ColorFormat::Full:
+			{
+				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
+				{
+					if (seeks[MeshAttribute_Colors + iCC] == -1)
+					{
+						if (previousFrame != nullptr)
+						{
+							frameMesh.ColorsF32[iCC] = previousFrame->Meshes[iMesh].ColorsF32[iCC];
+						}
+					}
+					else if (sizes[MeshAttribute_Colors + iCC] > 0)
+					{
+						frameMesh.ColorsF32[iCC] = (float*)&bufferAddress[seeks[MeshAttribute_Colors + iCC]];
+					}
+				}
+			
+				break;
+			}
+
+			case ColorFormat::Half:
+			{
+				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
+				{
+					if (seeks[MeshAttribute_Colors + iCC] == -1)
+					{
+						if (previousFrame != nullptr)
+						{
+							frameMesh.ColorsU16[iCC] = previousFrame->Meshes[iMesh].ColorsU16[iCC];
+						}
+					}
+					else if (sizes[MeshAttribute_Colors + iCC] > 0)
+					{
+						frameMesh.ColorsU16[iCC] = (uint16*)&bufferAddress[seeks[MeshAttribute_Colors + iCC]];
+					}
+				}
+				break;
+			}
+
+			case ColorFormat::Byte:
+			case ColorFormat::ByteHDR:
+			{
+
+				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
+				{
+					if (seeks[MeshAttribute_Colors + iCC] == -1)
+					{
+						if (previousFrame != nullptr)
+						{
+							frameMesh.ColorsU8[iCC] = previousFrame->Meshes[iMesh].ColorsU8[iCC];
+						}
+					}
+					else if (sizes[MeshAttribute_Colors + iCC] > 0)
+					{
+						frameMesh.ColorsU8[iCC] = (uint8*)&bufferAddress[seeks[MeshAttribute_Colors + iCC]];
+					}
+				}
+
+				break;
+			}
+
+			case ColorFormat::None:
+			default:
+			{
+				break;
+			}			
+		}
+
+		// remember which frame holds each attribute
+		for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+		{
+			if (seeks[iAttribute] == -1)
+			{
+				if (previousFrame != nullptr)
+				{
+					frameMesh.AttributeOwners[iAttribute] = previousFrame->Meshes[iMesh].AttributeOwners[iAttribute];
+					frameMesh.AttributeSizes[iAttribute] = previousFrame->Meshes[iMesh].AttributeSizes[iAttribute];
+				}
+			}
+			else if (sizes[iAttribute] > 0)
+			{
+				frameMesh.AttributeOwners[iAttribute] = &InOutFrame;
+				frameMesh.AttributeSizes[iAttribute] = sizes[iAttribute];
+			}
+		}
+	}
+
+	// setup the frame's image sequence data
+	InOutFrame.Images.resize(this->TOC.ImageSequences.size());
+
+	if (InOutFrame.ImagesPending)
+	{
+		// images are resolved once read, out of the frames before them if they reuse mipmaps
+		uint32 firstMipmapEntry = table.FirstMipmapEntries[iFrameInPage];
+		uint32 endMipmapEntry = table.FirstMipmapEntries[iFrameInPage + 1];
+
+		if (std::find(table.MipmapSeeks.begin() + firstMipmapEntry, table.MipmapSeeks.begin() + endMipmapEntry, -1) != table.MipmapSeeks.begin() + endMipmapEntry)
+		{
+			InOutFrame.ImagesPreviousFrame = previousFrame;
+		}
+
+		this->RetainAttributeOwners(InOutFrame, previousFrame);
+	}
+	else
+	{
+		// the previous frame's images may still be waiting to be read
+		if (previousFrame != nullptr && previousFrame->ImagesPending)
+		{
+			this->LoadFrameImages(previousFrame);
+		}
+
+		this->ResolveFrameImages(InOutFrame, previousFrame);
+
+		this->RetainAttributeOwners(InOutFrame, previousFrame);
+
+		InOutFrame.TOCPage = nullptr;
+	}
+
+	{
+		std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+
+		double processingTime = timeProcessingFrame.Duration();
+
+		this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond += processingTime;
+		this->Profiling.NumFramesProcessedInLastSecond++;
+
+		double weight = this->AverageProcessingTime > 0.0 ? MovingAverageWeight : 1.0;
+		this->AverageProcessingTime += (processingTime - this->AverageProcessingTime) * weight;
+	}
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ResolveFrameImages
+//-----------------------------------------------------------------------------
+void Kimura::Player::ResolveFrameImages(Frame& InOutFrame, const std::shared_ptr<Frame>& InPreviousFrame)
+{
+	KIMURA_TRACE("Kimura::Player::ResolveFrameImages");
+
+	const TOCFrameTable& table = *InOutFrame.TOCPage;
+	uint32 iFrameInPage = InOutFrame.FrameIndex - table.FirstFrame;
+
+	const byte* bufferAddress = InOutFrame.FrameData;
+
+	const FrameDataSelection& selection = FrameDataSelection::Get(InOutFrame.Selection);
+
+	uint32 numImageSequences = (uint32)this->TOC.ImageSequences.size();
+	uint32 iMipmapEntry = table.FirstMipmapEntries[iFrameInPage];
+
+	for (uint32 iImageSequence = 0; iImageSequence < numImageSequences; iImageSequence++)
+	{
+		// copy number of mipmaps used
+		uint32 numMipmaps = table.NumMipmaps[iFrameInPage * numImageSequences + iImageSequence];
+		InOutFrame.Images[iImageSequence].NumMipmaps = numMipmaps;
+
+		// for each mipmap, store pointer to data + size of data. Mipmaps larger than the minimum one aren't loaded.
+		FrameImageMipmap* pFrameMipmap = InOutFrame.Images[iImageSequence].Mipmaps;
+		for (uint32 iMipmap = 0; iMipmap < numMipmaps; iMipmap++, iMipmapEntry++)
+		{
+			if (!selection.IncludesMipmap(iImageSequence, iMipmap, numMipmaps))
+			{
+				pFrameMipmap->Data = nullptr;
+				pFrameMipmap->Size = 0;
+			}
+			else if (table.MipmapSeeks[iMipmapEntry] == -1)
+			{
+				if (InPreviousFrame != nullptr)
+				{
+					pFrameMipmap->Data = InPreviousFrame->Images[iImageSequence].Mipmaps[iMipmap].Data;
+					pFrameMipmap->Size = InPreviousFrame->Images[iImageSequence].Mipmaps[iMipmap].Size;
+					pFrameMipmap->Owner = InPreviousFrame->Images[iImageSequence].Mipmaps[iMipmap].Owner;
+				}
+			}
+			else
+			{
+				pFrameMipmap->Data = (void*)&bufferAddress[InOutFrame.GetBufferOffset((uint32)table.MipmapSeeks[iMipmapEntry])];
+				pFrameMipmap->Size = table.MipmapSizes[iMipmapEntry];
+				pFrameMipmap->Owner = &InOutFrame;
+			}
+
+			pFrameMipmap++;
+		}
+
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadNextFrameImages
+//-----------------------------------------------------------------------------
+bool Kimura::Player::LoadNextFrameImages()
+{
+	if (!this->Options.LowPriorityImages)
+	{
+		return false;
+	}
+
+	// images are read in the order the frames are played, once there's nothing else to do
+	std::shared_ptr<Frame> frame;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		uint32 numPositions = this->GetNumPlaybackPositions();
+		for (uint32 i = 0; i < this->FullyBufferedFramesCount; i++)
+		{
+			const std::shared_ptr<Frame>& bufferedFrame = this->Frames[this->GetFrameAtPosition((this->FullyBufferedFramesStart + i) % numPositions)];
+			if (bufferedFrame != nullptr && bufferedFrame->ImagesPending)
+			{
+				frame = bufferedFrame;
+				break;
+			}
+		}
+	}
+
+	return frame != nullptr && this->LoadFrameImages(frame);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadNextPinnedFrame
+//-----------------------------------------------------------------------------
+bool Kimura::Player::LoadNextPinnedFrame()
+{
+	if (MemoryBudget::Get().IsOverBudget())
+	{
+		return false;
+	}
+
+	// pinned frames are loaded in order, once there's nothing else to do
+	uint32 indexOfFrameToLoad = 0;
+	bool bPreviousFrameAvailable = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		uint32 numPinnedFrames = (uint32)this->PinnedFrames.size();
+		for (; indexOfFrameToLoad < numPinnedFrames; indexOfFrameToLoad++)
+		{
+			const std::shared_ptr<Frame>& frame = this->Frames[indexOfFrameToLoad];
+			if (this->PinnedFrames[indexOfFrameToLoad] != 0 && (frame == nullptr || !FrameDataSelection::Same(frame->Selection, this->Selection)))
+			{
+				break;
+			}
+		}
+
+		if (indexOfFrameToLoad == numPinnedFrames)
+		{
+			return false;
+		}
+
+		if (indexOfFrameToLoad > 0)
+		{
+			const std::shared_ptr<Frame>& previousFrame = this->Frames[indexOfFrameToLoad - 1];
+			bPreviousFrameAvailable = previousFrame != nullptr && FrameDataSelection::Same(previousFrame->Selection, this->Selection);
+		}
+	}
+
+	std::shared_ptr<const TOCFrameTable> page = this->AcquireTOCPage(indexOfFrameToLoad);
+	if (page == nullptr)
+	{
+		return false;
+	}
+
+	// the frames before it are only read for the data it reuses, as when seeking
+	uint32 firstDependency = indexOfFrameToLoad;
+	if (!bPreviousFrameAvailable && page->DependsOnPreviousFrames(indexOfFrameToLoad))
+	{
+		std::vector<std::shared_ptr<const FrameDataSelection>> selections;
+
+		if (!this->SelectReusedData(indexOfFrameToLoad, firstDependency, selections))
+		{
+			return false;
+		}
+
+		for (uint32 i = firstDependency; i < indexOfFrameToLoad; i++)
+		{
+			this->LoadFrameAt(i, selections[i - firstDependency]);
+		}
+	}
+
+	this->LoadFrameAt(indexOfFrameToLoad, this->Selection);
+
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	// and dropped once it's resolved
+	for (uint32 i = firstDependency; i < indexOfFrameToLoad; i++)
+	{
+		const std::shared_ptr<Frame>& frame = this->Frames[i];
+		if (frame != nullptr && !FrameDataSelection::Same(frame->Selection, this->Selection) && !this->IsFrameNeeded(i))
+		{
+			this->StoreFrame(i, nullptr);
+		}
+	}
+
+	// a frame that fails to load is left for later rather than retried right away
+	const std::shared_ptr<Frame>& frame = this->Frames[indexOfFrameToLoad];
+	return frame != nullptr && FrameDataSelection::Same(frame->Selection, this->Selection);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadFrameImages
+//-----------------------------------------------------------------------------
+bool Kimura::Player::LoadFrameImages(const std::shared_ptr<Frame>& InFrame)
+{
+	KIMURA_TRACE("Kimura::Player::LoadFrameImages");
+
+	// reused mipmaps point into the frames before, whose images are loaded first
+	std::vector<std::shared_ptr<Frame>> frames;
+	for (std::shared_ptr<Frame> frame = InFrame; frame != nullptr; )
+	{
+		std::shared_ptr<Frame> previousFrame;
+		{
+			std::unique_lock<std::mutex> imagesLock(frame->ImagesMutex);
+			if (!frame->ImagesPending)
+			{
+				break;
+			}
+
+			previousFrame = frame->ImagesPreviousFrame;
+		}
+
+		frames.push_back(frame);
+		frame = previousFrame;
+	}
+
+	for (auto iFrame = frames.rbegin(); iFrame != frames.rend(); ++iFrame)
+	{
+		Frame& frame = **iFrame;
+
+		// frames shared by the cursors of a clip are loaded by the first cursor to get there
+		std::unique_lock<std::mutex> imagesLock(frame.ImagesMutex);
+		if (!frame.ImagesPending)
+		{
+			continue;
+		}
+
+		const TOCFrameTable& table = *frame.TOCPage;
+		uint64 positionOfFrameInFile = this->FrameDataFilePosition + table.FilePositions[frame.FrameIndex - table.FirstFrame];
+
+		ScopedTime s;
+
+		uint64 bytesRead = 0;
+		for (const FrameDataRange& range : frame.DataRanges)
+		{
+			if (!range.Image)
+			{
+				continue;
+			}
+
+			if (!this->DataSource->ReadAt(positionOfFrameInFile + range.Offset, frame.Buffer + range.BufferOffset, range.Size))
+			{
+				this->Failure("Failed to read image data from file");
+				return false;
+			}
+
+			bytesRead += range.Size;
+		}
+
+		this->RecordFrameRead(bytesRead, s.Duration());
+
+		std::shared_ptr<Frame> previousFrame = frame.ImagesPreviousFrame;
+		this->ResolveFrameImages(frame, previousFrame);
+
+		// keep the frames holding reused mipmaps alive. They are the previous frame or among its own dependencies.
+		for (const FrameImage& frameImage : frame.Images)
+		{
+			for (uint32 iMipmap = 0; iMipmap < frameImage.NumMipmaps; iMipmap++)
+			{
+				const Frame* owner = frameImage.Mipmaps[iMipmap].Owner;
+				if (owner == nullptr || owner == &frame || previousFrame == nullptr)
+				{
+					continue;
+				}
+
+				auto IsOwner = [owner](const std::shared_ptr<Frame>& InDependency) { return InDependency.get() == owner; };
+
+				if (std::find_if(frame.ImageDependencies.begin(), frame.ImageDependencies.end(), IsOwner) != frame.ImageDependencies.end())
+				{
+					continue;
+				}
+
+				if (owner == previousFrame.get())
+				{
+					frame.ImageDependencies.push_back(previousFrame);
+					continue;
+				}
+
+				for (const std::vector<std::shared_ptr<Frame>>* dependencies : { &previousFrame->ImageDependencies, &previousFrame->FrameDependencies })
+				{
+					auto dependency = std::find_if(dependencies->begin(), dependencies->end(), IsOwner);
+					if (dependency != dependencies->end())
+					{
+						frame.ImageDependencies.push_back(*dependency);
+						break;
+					}
+				}
+			}
+		}
+
+		frame.ImagesPreviousFrame = nullptr;
+		frame.TOCPage = nullptr;
+
+		// from now on the frame hands its images out
+		frame.ImagesPending = false;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RetainAttributeOwners
+//-----------------------------------------------------------------------------
+void Kimura::Player::RetainAttributeOwners(Frame& InOutFrame, const std::shared_ptr<Frame>& InPreviousFrame)
+{
+	KIMURA_TRACE("Kimura::Player::RetainAttributeOwners");
+
+	// data of a memory mapped file lives as long as the mapping, no other frame needs to be kept around
+	if (InOutFrame.Mapping != nullptr || InPreviousFrame == nullptr)
+	{
+		return;
+	}
+
+	// small attributes held by frames far behind are copied over, breaking long chains of frames kept alive for little data
+	auto ShouldForward = [&InOutFrame](const Frame* InOwner, uint32 InSize)
+	{
+		return	InOwner != nullptr && InOwner != &InOutFrame && InSize <= MaxForwardedAttributeSize &&
+				InOutFrame.FrameIndex - InOwner->FrameIndex >= ForwardedAttributeFrameDistance;
+	};
+
+	const uint32 forwardedAlignment = 16;
+
+	uint64 forwardedSize = 0;
+	for (const FrameMesh& frameMesh : InOutFrame.Meshes)
+	{
+		for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+		{
+			if (ShouldForward(frameMesh.AttributeOwners[iAttribute], frameMesh.AttributeSizes[iAttribute]))
+			{
+				forwardedSize += (frameMesh.AttributeSizes[iAttribute] + forwardedAlignment - 1) & ~(uint64)(forwardedAlignment - 1);
+			}
+		}
+	}
+
+	for (const FrameImage& frameImage : InOutFrame.Images)
+	{
+		for (uint32 iMipmap = 0; iMipmap < frameImage.NumMipmaps; iMipmap++)
+		{
+			if (ShouldForward(frameImage.Mipmaps[iMipmap].Owner, frameImage.Mipmaps[iMipmap].Size))
+			{
+				forwardedSize += (frameImage.Mipmaps[iMipmap].Size + forwardedAlignment - 1) & ~(uint64)(forwardedAlignment - 1);
+			}
+		}
+	}
+
+	if (forwardedSize > 0)
+	{
+		// sized once, the copies must not move
+		InOutFrame.ForwardedData.resize((size_t)(forwardedSize + forwardedAlignment));
+
+		byte* forwardedData = InOutFrame.ForwardedData.data();
+		forwardedData += (forwardedAlignment - ((uintptr_t)forwardedData & (forwardedAlignment - 1))) & (forwardedAlignment - 1);
+
+		for (FrameMesh& frameMesh : InOutFrame.Meshes)
+		{
+			for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+			{
+				uint32 size = frameMesh.AttributeSizes[iAttribute];
+				if (ShouldForward(frameMesh.AttributeOwners[iAttribute], size))
+				{
+					memcpy(forwardedData, frameMesh.GetAttributeData(iAttribute), size);
+					frameMesh.SetAttributeData(iAttribute, forwardedData);
+					frameMesh.AttributeOwners[iAttribute] = &InOutFrame;
+
+					forwardedData += (size + forwardedAlignment - 1) & ~(uint64)(forwardedAlignment - 1);
+				}
+			}
+		}
+
+		for (FrameImage& frameImage : InOutFrame.Images)
+		{
+			for (uint32 iMipmap = 0; iMipmap < frameImage.NumMipmaps; iMipmap++)
+			{
+				FrameImageMipmap& frameMipmap = frameImage.Mipmaps[iMipmap];
+				if (ShouldForward(frameMipmap.Owner, frameMipmap.Size))
+				{
+					memcpy(forwardedData, frameMipmap.Data, frameMipmap.Size);
+					frameMipmap.Data = forwardedData;
+					frameMipmap.Owner = &InOutFrame;
+
+					forwardedData += (frameMipmap.Size + forwardedAlignment - 1) & ~(uint64)(forwardedAlignment - 1);
+				}
+			}
+		}
+	}
+
+	// keep the frames still holding reused data alive. They are either the previous frame or among its own dependencies.
+	auto RetainOwner = [&InOutFrame, &InPreviousFrame](const Frame* InOwner)
+	{
+		if (InOwner == nullptr || InOwner == &InOutFrame)
+		{
+			return;
+		}
+
+		for (const std::shared_ptr<Frame>& dependency : InOutFrame.FrameDependencies)
+		{
+			if (dependency.get() == InOwner)
+			{
+				return;
+			}
+		}
+
+		if (InOwner == InPreviousFrame.get())
+		{
+			InOutFrame.FrameDependencies.push_back(InPreviousFrame);
+			return;
+		}
+
+		for (const std::shared_ptr<Frame>& dependency : InPreviousFrame->FrameDependencies)
+		{
+			if (dependency.get() == InOwner)
+			{
+				InOutFrame.FrameDependencies.push_back(dependency);
+				return;
+			}
+		}
+	};
+
+	for (const FrameMesh& frameMesh : InOutFrame.Meshes)
+	{
+		for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+		{
+			RetainOwner(frameMesh.AttributeOwners[iAttribute]);
+		}
+	}
+
+	for (const FrameImage& frameImage : InOutFrame.Images)
+	{
+		for (uint32 iMipmap = 0; iMipmap < frameImage.NumMipmaps; iMipmap++)
+		{
+			RetainOwner(frameImage.Mipmaps[iMipmap].Owner);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::StoreFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::StoreFrame(uint32 iFrame, std::shared_ptr<Frame> InFrame)
+{
+	// expects FrameAccessMutex to be locked by the caller
+
+	// adjust memory footprint, pinned frames are accounted for separately
+	uint64& memoryUsage = this->IsFramePinned(iFrame) ? this->Profiling.MemoryUsageForPinnedFrames : this->Profiling.MemoryUsageForFrames;
+
+	if (this->Frames[iFrame] != nullptr)
+	{
+		memoryUsage -= this->Frames[iFrame]->BufferSize;
+	}
+
+	// GetFrameAt looks the frames up without locking
+	std::atomic_store(&this->Frames[iFrame], InFrame);
+
+	if (InFrame != nullptr)
+	{
+		memoryUsage += InFrame->BufferSize;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetNumFrames
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetNumFrames()
+{
+	if (this->Status != Kimura::PlayerStatus::Ready)
+	{
+		return 0;
+	}
+
+	return (Kimura::uint32)this->Frames.size();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetFrameAt
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameAt(uint32 iFrame, bool InForceWait)
+{
+	uint32 numFramesTotal = (uint32)this->Frames.size();
+
+	// expected that the frame index be within the full range of the playback
+	if (iFrame >= numFramesTotal)
+	{
+		// complain
+		return nullptr;
+	}
+
+	// no lock taken here. The buffered frames are only stored and dropped by the loading side, which picks up the 
+	// requested frame and drops the frames before it, or jumps to it when it isn't buffered nor about to be.
+	std::shared_ptr<Kimura::IFrame> r = this->FindBufferedFrame(iFrame);
+
+	if (r == nullptr)
+	{
+		this->RecordFrameMiss(iFrame);
+	}
+
+	this->MoveBufferingTo(iFrame);
+
+	// This will force blocking until the desired frame is ready
+	while (r == nullptr && InForceWait)
+	{
+		std::unique_lock<std::mutex> threadLock(this->WaitForFrameBufferedMutex);
+
+		// look again while holding the mutex so that a frame buffered in the meantime can't be missed
+		r = this->FindBufferedFrame(iFrame);
+
+		if (r == nullptr)
+		{
+			// wait until a frame has been obtained
+			this->WaitForFrameBufferedEvent.wait(threadLock);
+		}
+
+	}
+
+	return r;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RequestFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::RequestFrame(uint32 iFrame, std::function<void(std::shared_ptr<IFrame>)> InCallback)
+{
+	{
+		std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+		// the table of content is still being read, the request is taken in once the number of frames is known
+		if (!this->FrameCountKnown)
+		{
+			FrameRequest request;
+			request.FrameIndex = iFrame;
+			request.Callback = InCallback;
+			this->FrameRequests.push_back(request);
+			return;
+		}
+	}
+
+	if (iFrame >= (uint32)this->Frames.size())
+	{
+		InCallback(nullptr);
+		return;
+	}
+
+	if (this->FindBufferedFrame(iFrame) == nullptr)
+	{
+		this->RecordFrameMiss(iFrame);
+	}
+
+	this->MoveBufferingTo(iFrame);
+
+	{
+		std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+		FrameRequest request;
+		request.FrameIndex = iFrame;
+		request.Callback = InCallback;
+		this->FrameRequests.push_back(request);
+	}
+
+	// the frame may well be buffered already
+	this->CompleteFrameRequests();
+
+	// if not, and playback was requested elsewhere in the meantime, the loading side has to settle this request
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RequestFrame
+//-----------------------------------------------------------------------------
+std::future<std::shared_ptr<Kimura::IFrame>> Kimura::Player::RequestFrame(uint32 iFrame)
+{
+	std::shared_ptr<std::promise<std::shared_ptr<IFrame>>> promise = std::make_shared<std::promise<std::shared_ptr<IFrame>>>();
+	std::future<std::shared_ptr<IFrame>> future = promise->get_future();
+
+	this->RequestFrame(iFrame, [promise](std::shared_ptr<IFrame> InFrame) { promise->set_value(InFrame); });
+
+	return future;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::MoveBufferingTo
+//-----------------------------------------------------------------------------
+void Kimura::Player::MoveBufferingTo(uint32 iFrame)
+{
+	// special case when 'buffer entire playback' is on, nothing is ever dropped
+	if (this->Options.BufferEntirePlayback)
+	{
+		return;
+	}
+
+	this->LastFrameRequestTime = std::chrono::steady_clock::now().time_since_epoch().count();
+
+	if (this->RequestedFrame.exchange(iFrame) != iFrame)
+	{
+		// wake up the player's thread, it has work to do
+		this->WakeUpBufferThread();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::FindBufferedFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::FindBufferedFrame(uint32 iFrame)
+{
+	uint32 numFramesTotal = (uint32)this->Frames.size();
+
+	uint64 bufferedFrames = this->BufferedFrames.load();
+	uint32 start = (uint32)(bufferedFrames >> 32);
+	uint32 count = (uint32)bufferedFrames;
+
+	bool bFrameBuffered = iFrame < numFramesTotal && this->GetDistanceToFrame(start, iFrame) < count;
+
+	if (!bFrameBuffered)
+	{
+		return nullptr;
+	}
+
+	// dropped right after the window was published without it, if that's the case
+	std::shared_ptr<Frame> frame = std::atomic_load(&this->Frames[iFrame]);
+
+	// the slot may already be reused by the loading side, a stale lookup can only miss
+	if (frame == nullptr || frame->FrameIndex != iFrame || FrameDataSelection::Get(frame->Selection).ReusedDataOnly)
+	{
+		return nullptr;
+	}
+
+	return frame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RecordFrameMiss
+//-----------------------------------------------------------------------------
+void Kimura::Player::RecordFrameMiss(uint32 iFrame)
+{
+	uint64 bufferedFrames = this->BufferedFrames.load();
+	uint32 start = (uint32)(bufferedFrames >> 32);
+	uint32 count = (uint32)bufferedFrames;
+
+	// nothing buffered yet, or right after a jump: the wait is expected
+	if (count == 0)
+	{
+		return;
+	}
+
+	uint32 distance = this->GetDistanceToFrame(start, iFrame);
+
+	std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+
+	// within the frames being pre-buffered, playback got there before the frame did
+	if (distance < this->Profiling.PreBufferingSize && iFrame != this->LastStalledFrame)
+	{
+		this->Profiling.NumStalls++;
+		this->LastStalledFrame = iFrame;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ApplyFrameRequest
+//-----------------------------------------------------------------------------
+void Kimura::Player::ApplyFrameRequest()
+{
+	// expects FrameAccessMutex to be locked by the caller
+
+	if (this->SelectionChanged)
+	{
+		this->ApplyDataSelection();
+	}
+
+	if (!this->PinRequests.empty())
+	{
+		this->ApplyFramePins();
+	}
+
+	if (this->Options.BufferEntirePlayback)
+	{
+		return;
+	}
+
+	uint32 numPositions = this->GetNumPlaybackPositions();
+	uint32 iFrame = this->RequestedFrame.load();
+
+	// first, is this frame buffered? or in queue to be buffered? Requests are picked up later than they're made, the 
+	// frame may be up to a full pre-buffering past the last frame buffered, plus the frames read ahead. 
+	uint32 distanceFromStart = this->GetDistanceToFrame(this->FullyBufferedFramesStart, iFrame);
+
+	// without looping, playback starts over to get back to the frames before
+	uint32 positionOfFrame = distanceFromStart != FrameOutOfReach ? 
+		(this->FullyBufferedFramesStart + distanceFromStart) % numPositions : this->GetDistanceToFrame(0, iFrame);
+
+	bool bFrameBuffered = distanceFromStart < this->FullyBufferedFramesCount;
+	bool bFrameIntentedToBeBuffered = distanceFromStart < std::max(this->FullyBufferedFramesCount, 1u) - 1 + this->Options.PreBufferingSize + this->Options.RawPreBufferingSize;
+
+	// the frames dropped are taken out of the published window before being released
+	uint32 firstDroppedPosition = this->FullyBufferedFramesStart;
+	uint32 numDroppedFrames = 0;
+
+	if (bFrameBuffered)
+	{
+		// remove previous frames 
+		numDroppedFrames = distanceFromStart;
+		if (numDroppedFrames == 0)
+		{
+			// requests made for other frames in the meantime may still be waiting
+			this->SettleFrameRequests(this->FullyBufferedFramesStart);
+			return;
+		}
+
+		this->SettleFrameRequests(positionOfFrame);
+
+		this->FullyBufferedFramesStart = positionOfFrame;
+		this->FullyBufferedFramesCount -= numDroppedFrames;
+	}
+	else if (bFrameIntentedToBeBuffered)
+	{
+		// frame isn't loaded at this time but the player is already working to get there. The frames buffered so far 
+		// all come before it, only the last one is still needed, to resolve the frames after it.
+		if (this->FullyBufferedFramesCount <= 1)
+		{
+			this->SettleFrameRequests(this->FullyBufferedFramesStart);
+			return;
+		}
+
+		numDroppedFrames = this->FullyBufferedFramesCount - 1;
+
+		uint32 lastBufferedPosition = (this->FullyBufferedFramesStart + numDroppedFrames) % numPositions;
+		this->SettleFrameRequests(lastBufferedPosition);
+
+		this->FullyBufferedFramesStart = lastBufferedPosition;
+		this->FullyBufferedFramesCount = 1;
+	}
+	else
+	{
+		this->SettleFrameRequests(positionOfFrame);
+
+		// clear all buffered frames
+		numDroppedFrames = this->FullyBufferedFramesCount;
+
+		// reads queued for the previous location are now useless
+		this->PendingReads.clear();
+		this->ReadGeneration++;
+
+		// set new buffer start, carrying on in the same direction when the frame is played both ways
+		this->FullyBufferedFramesStart = positionOfFrame;
+		this->FullyBufferedFramesCount = 0;
+
+		std::atomic_store(&this->LatestFrame, std::shared_ptr<Frame>());
+	}
+
+	this->PublishBufferedFrames();
+
+	for (uint32 i = 0; i < numDroppedFrames; i++)
+	{
+		// the frames played both ways may still be buffered for the way back
+		uint32 iDroppedFrame = this->GetFrameAtPosition((firstDroppedPosition + i) % numPositions);
+		if (this->GetDistanceToFrame(this->FullyBufferedFramesStart, iDroppedFrame) >= this->FullyBufferedFramesCount && 
+			!this->IsFramePinned(iDroppedFrame))
+		{
+			this->StoreFrame(iDroppedFrame, nullptr);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ApplyDataSelection
+//-----------------------------------------------------------------------------
+void Kimura::Player::ApplyDataSelection()
+{
+	// expects FrameAccessMutex to be locked by the caller
+
+	this->SelectionChanged = false;
+
+	std::shared_ptr<const FrameDataSelection> selection = this->RequestedSelection;
+	this->RequestedSelection = nullptr;
+
+	if (FrameDataSelection::SameMeshData(selection, this->Selection))
+	{
+		// the mipmaps loaded only affect the frames to come
+		this->Selection = selection;
+		return;
+	}
+
+	this->Selection = selection;
+
+	// frames loaded so far miss data now needed, or reuse data of frames that don't have it. Everything is dropped and
+	// buffered again from the same frame, as after a jump.
+	this->SettleFrameRequests(this->FullyBufferedFramesStart);
+
+	this->PendingReads.clear();
+	this->ReadGeneration++;
+
+	this->FullyBufferedFramesCount = 0;
+
+	std::atomic_store(&this->LatestFrame, std::shared_ptr<Frame>());
+	this->PublishBufferedFrames();
+
+	for (uint32 i = 0; i < (uint32)this->Frames.size(); i++)
+	{
+		this->StoreFrame(i, nullptr);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ApplyMemoryBudget
+//-----------------------------------------------------------------------------
+bool Kimura::Player::ApplyMemoryBudget()
+{
+	MemoryBudget& budget = MemoryBudget::Get();
+
+	// the loop head given way by ReleaseBackBuffer is kept in memory again once it fits next to the frames buffered ahead,
+	// unless another shortage started. Pinned again any earlier, it would only be loaded to be released by the next shortage.
+	if (this->LoopHeadPinRequested)
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		if (budget.IsShortOfMemory() || this->LoopHeadPins.Pinned || this->LoopHeadPins.NumFrames == 0)
+		{
+			this->LoopHeadPinRequested = false;
+		}
+		else if (this->FullyBufferedFramesCount >= this->Options.PreBufferingSize && budget.HasRoomFor(this->ReleasedLoopHeadMemory))
+		{
+			this->LoopHeadPinRequested = false;
+
+			this->LoopHeadPins.Pinned = true;
+			this->PinRequests.push_back(this->LoopHeadPins);
+			this->ApplyFramePins();
+		}
+	}
+
+	if (!budget.IsOverBudget() && !budget.IsShortOfMemory() && !this->BackBufferReleaseRequested && !this->LookAheadShrinkRequested)
+	{
+		return true;
+	}
+
+	bool bReleased = false;
+	bool bWaitForMemory = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// the frames dropped by a jump may be all it takes
+		this->ApplyFrameRequest();
+
+		if (this->BackBufferReleaseRequested.exchange(false))
+		{
+			this->ReleaseBackBuffer();
+			bReleased = true;
+		}
+
+		if (this->LookAheadShrinkRequested.exchange(false))
+		{
+			this->ShrinkLookAhead();
+			bReleased = true;
+		}
+
+		// the frame played next is buffered no matter what, only the frames after it wait
+		uint32 numFramesComing = this->FullyBufferedFramesCount;
+		for (const std::shared_ptr<FrameRead>& pendingRead : this->PendingReads)
+		{
+			if (!pendingRead->Dependency)
+			{
+				numFramesComing++;
+			}
+		}
+
+		bWaitForMemory = budget.IsOverBudget() && this->GetDistanceToFrame(this->FullyBufferedFramesStart, this->RequestedFrame.load()) < numFramesComing;
+
+		// and so are the frames asked for with RequestFrame, whose callers would wait on them forever otherwise
+		if (bWaitForMemory)
+		{
+			std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+			for (const FrameRequest& request : this->FrameRequests)
+			{
+				if (!request.Settled && this->GetDistanceToFrame(this->FullyBufferedFramesStart, request.FrameIndex) >= numFramesComing)
+				{
+					bWaitForMemory = false;
+					break;
+				}
+			}
+		}
+	}
+
+	if (bReleased || !bWaitForMemory)
+	{
+		budget.NotifyReleased(this);
+	}
+
+	if (bWaitForMemory)
+	{
+		budget.Reclaim(this);
+	}
+
+	return !bWaitForMemory;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReleaseBackBuffer
+//-----------------------------------------------------------------------------
+void Kimura::Player::ReleaseBackBuffer()
+{
+	// expects FrameAccessMutex to be locked by the caller. Drops every frame playback doesn't need, such as the frames 
+	// behind it and the frames only read for the data of others, along with the buffers kept for reuse.
+
+	// the loop head gives way, unlike the frames pinned by the user
+	if (this->LoopHeadPins.Pinned)
+	{
+		this->ReleasedLoopHeadMemory = 0;
+
+		uint32 lastFrame = std::min(this->LoopHeadPins.FirstFrame + this->LoopHeadPins.NumFrames, (uint32)this->Frames.size());
+		for (uint32 i = this->LoopHeadPins.FirstFrame; i < lastFrame; i++)
+		{
+			if (this->Frames[i] != nullptr)
+			{
+				this->ReleasedLoopHeadMemory += this->Frames[i]->BufferSize;
+			}
+		}
+
+		this->LoopHeadPins.Pinned = false;
+		this->PinRequests.push_back(this->LoopHeadPins);
+		this->ApplyFramePins();
+	}
+
+	for (uint32 i = 0; i < (uint32)this->Frames.size(); i++)
+	{
+		if (this->Frames[i] != nullptr && !this->IsFrameNeeded(i))
+		{
+			this->StoreFrame(i, nullptr);
+		}
+	}
+
+	this->Pool->ReleaseFreeBuffers();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ShrinkLookAhead
+//-----------------------------------------------------------------------------
+void Kimura::Player::ShrinkLookAhead()
+{
+	// expects FrameAccessMutex to be locked by the caller. Gives up the second half of the frames buffered ahead. The 
+	// frame played next is kept, as well as a frame requested since and possibly already handed out.
+
+	uint32 numKeptFrames = std::max(this->FullyBufferedFramesCount / 2, std::min(this->FullyBufferedFramesCount, 1u));
+
+	uint32 distanceToRequestedFrame = this->GetDistanceToFrame(this->FullyBufferedFramesStart, this->RequestedFrame.load());
+	if (distanceToRequestedFrame < this->FullyBufferedFramesCount)
+	{
+		numKeptFrames = std::max(numKeptFrames, distanceToRequestedFrame + 1);
+	}
+	uint32 numDroppedFrames = this->FullyBufferedFramesCount - numKeptFrames;
+
+	// reads under way for the frames further ahead are discarded, as after a jump
+	this->PendingReads.clear();
+	this->ReadGeneration++;
+
+	if (numDroppedFrames == 0)
+	{
+		return;
+	}
+
+	uint32 numPositions = this->GetNumPlaybackPositions();
+	uint32 firstDroppedPosition = (this->FullyBufferedFramesStart + numKeptFrames) % numPositions;
+
+	this->FullyBufferedFramesCount = numKeptFrames;
+
+	std::atomic_store(&this->LatestFrame, this->Frames[this->GetFrameAtPosition((firstDroppedPosition + numPositions - 1) % numPositions)]);
+	this->PublishBufferedFrames();
+
+	for (uint32 i = 0; i < numDroppedFrames; i++)
+	{
+		uint32 iDroppedFrame = this->GetFrameAtPosition((firstDroppedPosition + i) % numPositions);
+		if (!this->IsFrameNeeded(iDroppedFrame))
+		{
+			this->StoreFrame(iDroppedFrame, nullptr);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetRetainedMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::Player::GetRetainedMemoryUsage()
+{
+	// the frames reusing the data of others keep them alive, and so on
+	uint64 memoryUsage = 0;
+
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	std::vector<const Frame*> framesToVisit;
+	for (const std::shared_ptr<Frame>& frame : this->Frames)
+	{
+		if (frame != nullptr)
+		{
+			framesToVisit.push_back(frame.get());
+		}
+	}
+
+	std::vector<bool> visitedFrames(this->Frames.size(), false);
+	while (!framesToVisit.empty())
+	{
+		const Frame* frame = framesToVisit.back();
+		framesToVisit.pop_back();
+
+		for (const std::vector<std::shared_ptr<Frame>>* dependencies : { &frame->FrameDependencies, &frame->ImageDependencies })
+		{
+			for (const std::shared_ptr<Frame>& dependency : *dependencies)
+			{
+				uint32 iFrame = dependency->FrameIndex;
+				if (iFrame >= (uint32)visitedFrames.size() || visitedFrames[iFrame] || this->Frames[iFrame] == dependency)
+				{
+					continue;
+				}
+
+				visitedFrames[iFrame] = true;
+				memoryUsage += dependency->BufferSize;
+
+				framesToVisit.push_back(dependency.get());
+			}
+		}
+	}
+
+	return memoryUsage;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetRawMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::Player::GetRawMemoryUsage(uint32& OutNumFrames)
+{
+	// the reads completed and left to resolve, frames shared with other cursors of a clip are theirs
+	uint64 memoryUsage = 0;
+	OutNumFrames = 0;
+
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	for (const std::shared_ptr<FrameRead>& pendingRead : this->PendingReads)
+	{
+		if (pendingRead->Completed && !pendingRead->Shared)
+		{
+			memoryUsage += pendingRead->Frame_->BufferSize;
+			OutNumFrames++;
+		}
+	}
+
+	return memoryUsage;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ApplyFramePins
+//-----------------------------------------------------------------------------
+void Kimura::Player::ApplyFramePins()
+{
+	// expects FrameAccessMutex to be locked by the caller
+
+	uint32 numFrames = (uint32)this->Frames.size();
+	this->PinnedFrames.resize(numFrames, 0);
+
+	for (const FramePinRequest& request : this->PinRequests)
+	{
+		uint8 pin = request.LoopHead ? PinnedLoopHead : PinnedByUser;
+
+		uint32 lastFrame = (uint32)std::min<uint64>((uint64)request.FirstFrame + request.NumFrames, numFrames);
+		for (uint32 i = request.FirstFrame; i < lastFrame; i++)
+		{
+			uint8 pins = request.Pinned ? (this->PinnedFrames[i] | pin) : (this->PinnedFrames[i] & ~pin);
+
+			// only the frames pinned or unpinned altogether change
+			bool bChanged = (pins != 0) != (this->PinnedFrames[i] != 0);
+			this->PinnedFrames[i] = pins;
+
+			if (!bChanged)
+			{
+				continue;
+			}
+
+			// the frames already loaded move from one memory footprint to the other
+			if (this->Frames[i] != nullptr)
+			{
+				uint64 bufferSize = this->Frames[i]->BufferSize;
+				if (request.Pinned)
+				{
+					this->Profiling.MemoryUsageForFrames -= bufferSize;
+					this->Profiling.MemoryUsageForPinnedFrames += bufferSize;
+				}
+				else
+				{
+					this->Profiling.MemoryUsageForPinnedFrames -= bufferSize;
+					this->Profiling.MemoryUsageForFrames += bufferSize;
+				}
+			}
+
+			// frames no longer pinned are dropped, unless playback still needs them
+			if (!request.Pinned && this->Frames[i] != nullptr && !this->IsFrameNeeded(i))
+			{
+				this->StoreFrame(i, nullptr);
+			}
+		}
+	}
+
+	this->PinRequests.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsFramePinned
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsFramePinned(uint32 iFrame)
+{
+	// expects FrameAccessMutex to be locked by the caller
+	return iFrame < this->PinnedFrames.size() && this->PinnedFrames[iFrame] != 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsFrameNeeded
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsFrameNeeded(uint32 iFrame)
+{
+	// expects FrameAccessMutex to be locked by the caller. Frames are needed while buffered, pinned, or until the read 
+	// of the frame after them is resolved.
+	if (this->GetDistanceToFrame(this->FullyBufferedFramesStart, iFrame) < this->FullyBufferedFramesCount || this->IsFramePinned(iFrame))
+	{
+		return true;
+	}
+
+	for (const std::shared_ptr<FrameRead>& pendingRead : this->PendingReads)
+	{
+		if (pendingRead->Frame_->FrameIndex == iFrame + 1)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::SetDataToLoad
+//-----------------------------------------------------------------------------
+void Kimura::Player::SetDataToLoad(const std::vector<bool>& InMeshes, uint32 InAttributes)
+{
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		FrameDataSelection selection = FrameDataSelection::Get(this->SelectionChanged ? this->RequestedSelection : this->Selection);
+		selection.Meshes = InMeshes;
+		selection.Attributes = InAttributes;
+
+		this->RequestDataSelection(selection);
+	}
+
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::SetMinimumImageMipmap
+//-----------------------------------------------------------------------------
+void Kimura::Player::SetMinimumImageMipmap(uint32 InImageSequence, uint32 InMipmap)
+{
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		FrameDataSelection selection = FrameDataSelection::Get(this->SelectionChanged ? this->RequestedSelection : this->Selection);
+		if (selection.MinimumMipmaps.size() <= InImageSequence)
+		{
+			selection.MinimumMipmaps.resize(InImageSequence + 1, 0);
+		}
+		selection.MinimumMipmaps[InImageSequence] = InMipmap;
+
+		this->RequestDataSelection(selection);
+	}
+
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PinFrames
+//-----------------------------------------------------------------------------
+void Kimura::Player::PinFrames(uint32 InFirstFrame, uint32 InNumFrames)
+{
+	this->RequestFramePins(InFirstFrame, InNumFrames, true);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::UnpinFrames
+//-----------------------------------------------------------------------------
+void Kimura::Player::UnpinFrames(uint32 InFirstFrame, uint32 InNumFrames)
+{
+	this->RequestFramePins(InFirstFrame, InNumFrames, false);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RequestFramePins
+//-----------------------------------------------------------------------------
+void Kimura::Player::RequestFramePins(uint32 InFirstFrame, uint32 InNumFrames, bool InPinned)
+{
+	// picked up by the loading side, before it buffers its next frame
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		this->PinRequests.push_back({ InFirstFrame, InNumFrames, InPinned, false });
+	}
+
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RequestDataSelection
+//-----------------------------------------------------------------------------
+void Kimura::Player::RequestDataSelection(const FrameDataSelection& InSelection)
+{
+	// expects FrameAccessMutex to be locked by the caller. Picked up by the loading side, before it buffers its next frame.
+
+	this->RequestedSelection = FrameDataSelection::Create(InSelection.Meshes, InSelection.Attributes, InSelection.MinimumMipmaps, this->Options.LowPriorityImages);
+	this->SelectionChanged = true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::SettleFrameRequests
+//-----------------------------------------------------------------------------
+void Kimura::Player::SettleFrameRequests(uint32 InNewBufferedFramesStart)
+{
+	// expects FrameAccessMutex to be locked by the caller, with the buffered frames about to start elsewhere
+
+	std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+	for (FrameRequest& request : this->FrameRequests)
+	{
+		if (request.Settled)
+		{
+			continue;
+		}
+
+		uint32 iFrame = request.FrameIndex;
+
+		// requests for frames still to come once buffering resumes from the new start are left alone
+		uint32 distanceFromNewStart = this->GetDistanceToFrame(InNewBufferedFramesStart, iFrame);
+		if (distanceFromNewStart < this->Options.PreBufferingSize)
+		{
+			continue;
+		}
+
+		// the others get their frame while it's still there, if it is
+		uint32 distanceFromStart = this->GetDistanceToFrame(this->FullyBufferedFramesStart, iFrame);
+		if (distanceFromStart < this->FullyBufferedFramesCount)
+		{
+			request.Frame_ = this->Frames[iFrame];
+		}
+
+		request.Settled = true;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::CompleteFrameRequests
+//-----------------------------------------------------------------------------
+void Kimura::Player::CompleteFrameRequests(bool InAbandonPending /*= false*/)
+{
+	std::vector<FrameRequest> completedRequests;
+
+	{
+		std::unique_lock<std::mutex> requestsLock(this->FrameRequestsMutex);
+
+		if (this->FrameRequests.empty())
+		{
+			return;
+		}
+
+		std::vector<FrameRequest>::iterator it = this->FrameRequests.begin();
+		while (it != this->FrameRequests.end())
+		{
+			if (!it->Settled)
+			{
+				it->Frame_ = this->FindBufferedFrame(it->FrameIndex);
+				it->Settled = it->Frame_ != nullptr || InAbandonPending;
+			}
+
+			if (it->Settled)
+			{
+				completedRequests.push_back(*it);
+				it = this->FrameRequests.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	// outside of the lock, the callbacks are free to make new requests
+	for (FrameRequest& request : completedRequests)
+	{
+		request.Callback(request.Frame_);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PublishBufferedFrames
+//-----------------------------------------------------------------------------
+void Kimura::Player::PublishBufferedFrames()
+{
+	// expects FrameAccessMutex to be locked by the caller
+	this->BufferedFrames = ((uint64)this->FullyBufferedFramesStart << 32) | this->FullyBufferedFramesCount;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetLatestFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetLatestFrame()
+{
+	return std::atomic_load(&this->LatestFrame);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetConstantFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetConstantFrame()
+{
+	return this->FirstFrame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsForcing16BitIndices
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsForcing16BitIndices()
+{
+	return this->TOC.Force16BitIndices;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::RetrievePlaybackInformation
+//-----------------------------------------------------------------------------
+bool Kimura::Player::RetrievePlaybackInformation(PlaybackInformation& OutInfo)
+{
+	if (this->Status != PlayerStatus::Ready)
+	{
+		return false;
+	}
+
+	OutInfo.FrameRate = this->TOC.FrameRate;
+	OutInfo.TimePerFrame = this->TOC.TimePerFrame;
+	OutInfo.FrameCount = this->TOC.NumFrames;
+	OutInfo.Duration = OutInfo.FrameCount * OutInfo.TimePerFrame;
+
+	OutInfo.Meshes.resize(this->TOC.Meshes.size());
+	for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
+	{
+		OutInfo.Meshes[iMesh].Index = iMesh;
+		OutInfo.Meshes[iMesh].Name = this->TOC.Meshes[iMesh].Name;
+		OutInfo.Meshes[iMesh].MaximumVertices = this->TOC.Meshes[iMesh].MaxVertices;
+		OutInfo.Meshes[iMesh].MaximumSurfaces= this->TOC.Meshes[iMesh].MaxSurfaces;
+		OutInfo.Meshes[iMesh].Force16BitIndices = this->TOC.Force16BitIndices;
+		OutInfo.Meshes[iMesh].PositionFormat_ = this->TOC.Meshes[iMesh].PositionFormat_;
+		OutInfo.Meshes[iMesh].NormalFormat_ = this->TOC.Meshes[iMesh].NormalFormat_;
+		OutInfo.Meshes[iMesh].TangentFormat_ = this->TOC.Meshes[iMesh].TangentFormat_;
+		OutInfo.Meshes[iMesh].VelocityFormat_ = this->TOC.Meshes[iMesh].VelocityFormat_;
+		OutInfo.Meshes[iMesh].TexCoordFormat_ = this->TOC.Meshes[iMesh].TexCoordFormat_;
+		OutInfo.Meshes[iMesh].ColorFormat_ = this->TOC.Meshes[iMesh].ColorFormat_;
+	}
+
+	OutInfo.ImageSequences.resize(this->TOC.ImageSequences.size());
+	for (uint32 i = 0; i < this->TOC.ImageSequences.size(); i++)
+	{
+		OutInfo.ImageSequences[i].Index = i;
+		OutInfo.ImageSequences[i].Name = this->TOC.ImageSequences[i].Name;
+		OutInfo.ImageSequences[i].Constant = this->TOC.ImageSequences[i].Constant;
+		OutInfo.ImageSequences[i].Width = this->TOC.ImageSequences[i].Width;
+		OutInfo.ImageSequences[i].Height = this->TOC.ImageSequences[i].Height;
+		OutInfo.ImageSequences[i].Mipmaps = this->TOC.ImageSequences[i].MipMapCount;
+		switch (this->TOC.ImageSequences[i].Format)
+		{
+			case ImageFormat::RGBA8:
+			{
+				OutInfo.ImageSequences[i].Format = "RGBA8";
+				break;
+			}
+
+			case ImageFormat::DXT1:
+			{
+				OutInfo.ImageSequences[i].Format = "DXT1";
+				break;
+			}
+
+			case ImageFormat::DXT3:
+			{
+				OutInfo.ImageSequences[i].Format = "DXT3";
+				break;
+			}
+
+			case ImageFormat::DXT5:
+			{
+				OutInfo.ImageSequences[i].Format = "DXT5";
+				break;
+			}
+
+		}
+
+	}
+
+	return true;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Frame::CollectStats
+//-----------------------------------------------------------------------------
+void Kimura::Player::CollectStats(PlayerStats& OutStats)
+{
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+	if (now > this->NextStatsCollection)
+	{
+		// only the resident pages of the table of content count
+		uint64 memoryUsageForTableOfContent = 0;
+		{
+			std::unique_lock<std::mutex> pagesLock(this->TOCPagesMutex);
+
+			for (const std::shared_ptr<TOCFrameTable>& page : this->TOCPages)
+			{
+				if (page != nullptr)
+				{
+					memoryUsageForTableOfContent += page->GetMemoryUsage();
+				}
+			}
+		}
+
+		uint64 memoryUsageForRetainedFrames = this->GetRetainedMemoryUsage();
+
+		uint32 numRawFrames = 0;
+		uint64 memoryUsageForRawFrames = this->GetRawMemoryUsage(numRawFrames);
+
+		std::unique_lock<std::mutex> threadLock(this->ProfilingMutex);
+
+		this->StoredProfiling.MemoryUsageForRetainedFrames = memoryUsageForRetainedFrames;
+		this->StoredProfiling.MemoryUsageForRawFrames = memoryUsageForRawFrames;
+		this->StoredProfiling.RawFramesCount = numRawFrames;
+		this->StoredProfiling.BytesReadInLastSecond = this->Profiling.BytesReadInLastSecond;
+		this->StoredProfiling.MemoryUsageForFrames = this->Profiling.MemoryUsageForFrames;
+		this->StoredProfiling.MemoryUsageForPinnedFrames = this->Profiling.MemoryUsageForPinnedFrames;
+		this->StoredProfiling.PreBufferingSize = this->Profiling.PreBufferingSize;
+		this->StoredProfiling.ReadMethod = this->Profiling.ReadMethod;
+		this->StoredProfiling.MemoryUsageForTableOfContent = memoryUsageForTableOfContent;
+
+		// update stats
+		this->StoredProfiling.AvgTimeSpentOnReadingFromDiskPerFrame = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
+		this->StoredProfiling.AvgTimeSpentOnProcessingPerFrames = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
+		this->StoredProfiling.TotalTimeSpentOnReadingFromDiskInLastSecond = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond;
+		this->StoredProfiling.TotalTimeSpentOnProcessingFramesInLastSecond = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond;
+		this->StoredProfiling.NumFramesProcessedInLastSecond = this->Profiling.NumFramesProcessedInLastSecond;
+
+		this->Profiling.BytesReadInLastSecond = 0;
+		this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond = 0;
+		this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond = 0;
+		this->Profiling.NumFramesProcessedInLastSecond = 0;
+
+		// c++ 14
+		//using namespace std::literals;
+		//this->NextStatsCollection = now + 1s;
+
+		// c++ 11
+		this->NextStatsCollection = now + std::chrono::seconds{1};
+
+	}
+
+	OutStats = this->StoredProfiling;
+
+	// a running count, up to date on every call
+	{
+		std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+		OutStats.NumStalls = this->Profiling.NumStalls;
+	}
+
+	uint64 bufferedFrames = this->BufferedFrames.load();
+	OutStats.BufferedFramesStart = this->GetFrameAtPosition((uint32)(bufferedFrames >> 32));
+	OutStats.BufferedFramesCount = (uint32)bufferedFrames;
+
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Frame::GetBufferedFrameCount
+//-----------------------------------------------------------------------------
+int Kimura::Player::GetBufferedFrameCount()
+{
+	return (int)(uint32)this->BufferedFrames.load();
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::Clip
+//-----------------------------------------------------------------------------
+Kimura::Clip::Clip(const std::string& InPath, const PlayerOptions& InOptions)
+	:
+	Options(InOptions),
+	Source(InPath)
+{
+	this->Pool = std::make_shared<FramePool>(InOptions);
+
+	// the source opens the file the cursors read through
+	this->Source.Options.CacheDirectory = InOptions.CacheDirectory;
+	this->Source.Options.CacheSize = InOptions.CacheSize;
+	this->Source.Options.Throttle = InOptions.Throttle;
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::Clip
+//-----------------------------------------------------------------------------
+Kimura::Clip::Clip(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions)
+	:
+	Options(InOptions),
+	Source(InSource)
+{
+	this->Pool = std::make_shared<FramePool>(InOptions);
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::~Clip
+//-----------------------------------------------------------------------------
+Kimura::Clip::~Clip()
+{
+	this->Source.CloseInputFile();
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::Open
+//-----------------------------------------------------------------------------
+bool Kimura::Clip::Open()
+{
+	KIMURA_TRACE("Kimura::Clip::Open");
+
+	// the source's file stays open, pages of the table of content are read through it as the cursors need them
+	if (!this->Source.OpenInputFile())
+	{
+		return false;
+	}
+
+	if (!this->Source.ReadTOC())
+	{
+		this->Source.CloseInputFile();
+		return false;
+	}
+
+	this->Source.Status = PlayerStatus::Ready;
+
+	this->TOCPages.resize(this->Source.TOCPages.size());
+	this->Frames.resize(this->Source.TOC.NumFrames);
+
+	// frames point into the memory of the source or into the file's mapping, if requested. Cursors reading through 
+	// the host don't use either.
+	if (this->Options.ExternalReadQueueDepth > 0)
+	{
+		// the host reads the frames
+	}
+	else if (this->Source.DataSource->GetData() != nullptr)
+	{
+		// already in memory
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (mapping->Open(this->Source.DataSource))
+		{
+			this->Mapping = mapping;
+		}
+	}
+	else if (this->Options.MemoryMappedFile && !this->Source.InputFilePath.empty() && !this->Source.DataSourceWrapsFile)
+	{
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (mapping->Open(this->Source.InputFilePath))
+		{
+			this->Mapping = mapping;
+		}
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::GetStatus
+//-----------------------------------------------------------------------------
+Kimura::PlayerStatus Kimura::Clip::GetStatus()
+{
+	return this->Source.GetStatus();
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::GetFailStatusMessage
+//-----------------------------------------------------------------------------
+void Kimura::Clip::GetFailStatusMessage(std::string& OutMessage)
+{
+	this->Source.GetFailStatusMessage(OutMessage);
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::RetrievePlaybackInformation
+//-----------------------------------------------------------------------------
+bool Kimura::Clip::RetrievePlaybackInformation(PlaybackInformation& OutInfo)
+{
+	return this->Source.RetrievePlaybackInformation(OutInfo);
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::CreateCursor
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IPlayer> Kimura::Clip::CreateCursor()
+{
+	if (this->GetStatus() != PlayerStatus::Ready)
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<Player>(this->shared_from_this());
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::AcquireTOCPage
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::TOCFrameTable> Kimura::Clip::AcquireTOCPage(uint32 iPage)
+{
+	KIMURA_TRACE("Kimura::Clip::AcquireTOCPage");
+
+	// loaded while holding the lock, cursors asking for the same page wait for it rather than reading it again
+	std::unique_lock<std::mutex> cacheLock(this->CacheMutex);
+
+	if (iPage >= (uint32)this->TOCPages.size())
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<TOCFrameTable> page = this->TOCPages[iPage].lock();
+	if (page == nullptr)
+	{
+		page = this->Source.LoadTOCPage(iPage);
+		this->TOCPages[iPage] = page;
+	}
+
+	return page;
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::FindFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Clip::FindFrame(uint32 iFrame, const std::shared_ptr<const FrameDataSelection>& InSelection)
+{
+	std::shared_ptr<Frame> frame;
+	{
+		std::unique_lock<std::mutex> cacheLock(this->CacheMutex);
+		frame = this->Frames[iFrame].lock();
+	}
+
+	if (frame == nullptr || !FrameDataSelection::Same(frame->Selection, InSelection))
+	{
+		return nullptr;
+	}
+
+	return frame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Clip::ShareFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Clip::ShareFrame(const std::shared_ptr<Frame>& InFrame)
+{
+	std::unique_lock<std::mutex> cacheLock(this->CacheMutex);
+
+	std::weak_ptr<Frame>& sharedFrame = this->Frames[InFrame->FrameIndex];
+
+	std::shared_ptr<Frame> frame = sharedFrame.lock();
+	if (frame == nullptr)
+	{
+		sharedFrame = InFrame;
+		return InFrame;
+	}
+
+	// cursors loading other meshes or attributes keep their own frames
+	if (!FrameDataSelection::Same(frame->Selection, InFrame->Selection))
+	{
+		return InFrame;
+	}
+
+	return frame;
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::FramePool
+//-----------------------------------------------------------------------------
+Kimura::FramePool::FramePool(const PlayerOptions& InOptions)
+	:
+	Allocator(InOptions.FrameAllocator),
+	HugePages(InOptions.HugePageFrameBuffers)
+{
+	this->MaxFreeFrames = InOptions.BackBufferSize + InOptions.PreBufferingSize + 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::~FramePool
+//-----------------------------------------------------------------------------
+Kimura::FramePool::~FramePool()
+{
+	for (Frame* frame : this->FreeFrames)
+	{
+		delete frame;
+	}
+
+	for (std::pair<const uint64, byte*>& freeBuffer : this->FreeBuffers)
+	{
+		this->Free(freeBuffer.second, freeBuffer.first);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::AcquireFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::FramePool::AcquireFrame()
+{
+	Frame* frame = nullptr;
+	{
+		std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+
+		if (!this->FreeFrames.empty())
+		{
+			frame = this->FreeFrames.back();
+			this->FreeFrames.pop_back();
+		}
+	}
+
+	if (frame == nullptr)
+	{
+		frame = new Frame();
+	}
+
+	// the frame comes back to the pool once both the player and the user are done with it
+	std::shared_ptr<FramePool> pool = this->shared_from_this();
+
+	return std::shared_ptr<Frame>(frame, [pool](Frame* InFrame) { pool->ReleaseFrame(InFrame); });
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::PrepareBuffer
+//-----------------------------------------------------------------------------
+Kimura::byte* Kimura::FramePool::PrepareBuffer(Frame& InOutFrame, uint64 InSize)
+{
+	if (InOutFrame.Buffer == nullptr || InOutFrame.BufferCapacity < InSize)
+	{
+		if (InOutFrame.Buffer != nullptr)
+		{
+			this->ReleaseBuffer(InOutFrame.Buffer, InOutFrame.BufferCapacity);
+			InOutFrame.Buffer = nullptr;
+			InOutFrame.BufferCapacity = 0;
+		}
+
+		uint64 capacity = this->GetCapacity(InSize);
+		byte* data = nullptr;
+		{
+			std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+
+			// smallest recycled buffer large enough, as long as at least half of it gets used
+			std::multimap<uint64, byte*>::iterator freeBuffer = this->FreeBuffers.lower_bound(capacity);
+			if (freeBuffer != this->FreeBuffers.end() && freeBuffer->first <= capacity * 2)
+			{
+				capacity = freeBuffer->first;
+				data = freeBuffer->second;
+				this->FreeBuffers.erase(freeBuffer);
+			}
+		}
+
+		if (data == nullptr)
+		{
+			data = this->Allocate(capacity);
+			if (data == nullptr)
+			{
+				return nullptr;
+			}
+
+			MemoryBudget::Get().Charge((int64)capacity);
+		}
+
+		InOutFrame.Buffer = data;
+		InOutFrame.BufferCapacity = capacity;
+	}
+
+	InOutFrame.BufferSize = InSize;
+
+	return InOutFrame.Buffer;
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::ReleaseFreeBuffers
+//-----------------------------------------------------------------------------
+void Kimura::FramePool::ReleaseFreeBuffers()
+{
+	std::multimap<uint64, byte*> freeBuffers;
+	{
+		std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+		freeBuffers.swap(this->FreeBuffers);
+	}
+
+	for (std::pair<const uint64, byte*>& freeBuffer : freeBuffers)
+	{
+		this->Free(freeBuffer.second, freeBuffer.first);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::SetMaxFreeFrames
+//-----------------------------------------------------------------------------
+void Kimura::FramePool::SetMaxFreeFrames(uint32 InMaxFreeFrames)
+{
+	std::vector<Frame*> freeFrames;
+	std::vector<std::pair<uint64, byte*>> freeBuffers;
+	{
+		std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+
+		this->MaxFreeFrames = InMaxFreeFrames;
+
+		while (this->FreeFrames.size() > this->MaxFreeFrames)
+		{
+			freeFrames.push_back(this->FreeFrames.back());
+			this->FreeFrames.pop_back();
+		}
+
+		// the largest buffers go first
+		while (this->FreeBuffers.size() > this->MaxFreeFrames)
+		{
+			std::multimap<uint64, byte*>::iterator it = std::prev(this->FreeBuffers.end());
+			freeBuffers.push_back(*it);
+			this->FreeBuffers.erase(it);
+		}
+	}
+
+	for (Frame* frame : freeFrames)
+	{
+		delete frame;
+	}
+
+	for (std::pair<uint64, byte*>& freeBuffer : freeBuffers)
+	{
+		this->Free(freeBuffer.second, freeBuffer.first);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::GetCapacity
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::FramePool::GetCapacity(uint64 InSize) const
+{
+	if (InSize <= BufferAlignment)
+	{
+		return BufferAlignment;
+	}
+
+	// 4 sizes per power of 2, no more than a quarter of the buffer goes unused
+	uint64 powerOf2 = BufferAlignment;
+	while (powerOf2 * 2 < InSize)
+	{
+		powerOf2 *= 2;
+	}
+
+	uint64 step = powerOf2 / 4;
+	uint64 capacity = (InSize + step - 1) / step * step;
+
+	if (this->HugePages && this->Allocator == nullptr && capacity >= HugePageSize)
+	{
+		capacity = (capacity + HugePageSize - 1) / HugePageSize * HugePageSize;
+	}
+
+	return capacity;
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::ReleaseFrame
+//-----------------------------------------------------------------------------
+void Kimura::FramePool::ReleaseFrame(Frame* InFrame)
+{
+	// outside of the lock, letting go of its dependencies can release other frames
+	InFrame->Reset();
+
+	if (InFrame->Buffer != nullptr)
+	{
+		this->ReleaseBuffer(InFrame->Buffer, InFrame->BufferCapacity);
+
+		InFrame->Buffer = nullptr;
+		InFrame->BufferCapacity = 0;
+	}
+
+	{
+		std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+
+		if (this->FreeFrames.size() < this->MaxFreeFrames)
+		{
+			this->FreeFrames.push_back(InFrame);
+			return;
+		}
+	}
+
+	delete InFrame;
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::ReleaseBuffer
+//-----------------------------------------------------------------------------
+void Kimura::FramePool::ReleaseBuffer(byte* InData, uint64 InCapacity)
+{
+	// over the memory budget, buffers are given back rather than kept for reuse
+	if (!MemoryBudget::Get().IsOverBudget())
+	{
+		std::unique_lock<std::mutex> poolLock(this->PoolMutex);
+
+		if (this->FreeBuffers.size() < this->MaxFreeFrames)
+		{
+			this->FreeBuffers.insert(std::make_pair(InCapacity, InData));
+			return;
+		}
+	}
+
+	this->Free(InData, InCapacity);
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::Allocate
+//-----------------------------------------------------------------------------
+Kimura::byte* Kimura::FramePool::Allocate(uint64 InCapacity)
+{
+	if (this->Allocator != nullptr)
+	{
+		return (byte*)this->Allocator->Allocate(InCapacity, BufferAlignment);
+	}
+
+	bool bHugePages = this->HugePages && InCapacity >= HugePageSize;
+
+#if defined(KIMURA_UNREAL)
+
+	return (byte*)FMemory::Malloc(InCapacity, BufferAlignment);
+
+#elif defined(KIMURA_WINDOWS)
+
+	if (bHugePages)
+	{
+		// large pages require the "Lock pages in memory" privilege. Without it, use regular pages.
+		void* data = VirtualAlloc(nullptr, (SIZE_T)InCapacity, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (data == nullptr)
+		{
+			data = VirtualAlloc(nullptr, (SIZE_T)InCapacity, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		}
+
+		return (byte*)data;
+	}
+
+	return (byte*)_aligned_malloc((size_t)InCapacity, BufferAlignment);
+
+#else
+
+	if (bHugePages)
+	{
+		void* data = mmap(nullptr, (size_t)InCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+	#if defined(MADV_HUGEPAGE)
+		// transparent huge pages, only a hint
+		madvise(data, (size_t)InCapacity, MADV_HUGEPAGE);
+	#endif
+
+		return (byte*)data;
+	}
+
+	void* data = nullptr;
+	if (posix_memalign(&data, BufferAlignment, (size_t)InCapacity) != 0)
+	{
+		return nullptr;
+	}
+
+	return (byte*)data;
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// FramePool::Free
+//-----------------------------------------------------------------------------
+void Kimura::FramePool::Free(byte* InData, uint64 InCapacity)
+{
+	MemoryBudget::Get().Charge(-(int64)InCapacity);
+
+	if (this->Allocator != nullptr)
+	{
+		this->Allocator->Free(InData, InCapacity);
+		return;
+	}
+
+	bool bHugePages = this->HugePages && InCapacity >= HugePageSize;
+
+#if defined(KIMURA_UNREAL)
+
+	FMemory::Free(InData);
+
+#elif defined(KIMURA_WINDOWS)
+
+	if (bHugePages)
+	{
+		VirtualFree(InData, 0, MEM_RELEASE);
+		return;
+	}
+
+	_aligned_free(InData);
+
+#else
+
+	if (bHugePages)
+	{
+		munmap(InData, (size_t)InCapacity);
+		return;
+	}
+
+	free(InData);
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFile::~MappedFile
+//-----------------------------------------------------------------------------
+Kimura::MappedFile::~MappedFile()
+{
+	// memory of a byte source, nothing was mapped
+	if (this->Source != nullptr)
+	{
+		this->Data = nullptr;
+		this->Size = 0;
+		return;
+	}
+
+#if defined(KIMURA_UNREAL)
+
+	if (this->UEMappedRegion != nullptr)
+	{
+		delete this->UEMappedRegion;
+		this->UEMappedRegion = nullptr;
+	}
+
+	if (this->UEMappedHandle != nullptr)
+	{
+		delete this->UEMappedHandle;
+		this->UEMappedHandle = nullptr;
+	}
+
+#elif defined(KIMURA_WINDOWS)
+
+	if (this->Data != nullptr)
+	{
+		UnmapViewOfFile(this->Data);
+	}
+
+	if (this->MappingHandle != nullptr)
+	{
+		CloseHandle(this->MappingHandle);
+	}
+
+	if (this->FileHandle != nullptr)
+	{
+		CloseHandle(this->FileHandle);
+	}
+
+#else
+
+	if (this->Data != nullptr)
+	{
+		munmap((void*)this->Data, this->Size);
+	}
+
+	if (this->FileDescriptor != -1)
+	{
+		close(this->FileDescriptor);
+	}
+
+#endif
+
+	this->Data = nullptr;
+	this->Size = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFile::Open
+//-----------------------------------------------------------------------------
+bool Kimura::MappedFile::Open(const std::string& InPath)
+{
+	KIMURA_TRACE("Kimura::MappedFile::Open");
+
+#if defined(KIMURA_UNREAL)
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	this->UEMappedHandle = PlatformFile.OpenMapped(*FString(InPath.c_str()));
+	if (this->UEMappedHandle == nullptr)
+	{
+		return false;
+	}
+
+	this->UEMappedRegion = this->UEMappedHandle->MapRegion(0, this->UEMappedHandle->GetFileSize());
+	if (this->UEMappedRegion == nullptr)
+	{
+		return false;
+	}
+
+	this->Data = (const byte*)this->UEMappedRegion->GetMappedPtr();
+	this->Size = (uint64)this->UEMappedRegion->GetMappedSize();
+
+#elif defined(KIMURA_WINDOWS)
+
+	this->FileHandle = CreateFileA(InPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->FileHandle == INVALID_HANDLE_VALUE)
+	{
+		this->FileHandle = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(this->FileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		return false;
+	}
+
+	this->MappingHandle = CreateFileMappingA(this->FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (this->MappingHandle == nullptr)
+	{
+		return false;
+	}
+
+	this->Data = (const byte*)MapViewOfFile(this->MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (this->Data == nullptr)
+	{
+		return false;
+	}
+
+	this->Size = (uint64)fileSize.QuadPart;
+
+#else
+
+	this->FileDescriptor = open(InPath.c_str(), O_RDONLY);
+	if (this->FileDescriptor == -1)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(this->FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, this->FileDescriptor, 0);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	this->Data = (const byte*)data;
+	this->Size = (uint64)fileStat.st_size;
+
+#endif
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFile::Open
+//-----------------------------------------------------------------------------
+bool Kimura::MappedFile::Open(std::shared_ptr<IByteSource> InSource)
+{
+	if (InSource->GetData() == nullptr || InSource->GetSize() == 0)
+	{
+		return false;
+	}
+
+	// kept alive for as long as frames point into it
+	this->Source = InSource;
+
+	this->Data = (const byte*)InSource->GetData();
+	this->Size = InSource->GetSize();
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFile::Touch
+//-----------------------------------------------------------------------------
+void Kimura::MappedFile::Touch(uint64 InOffset, uint64 InSize)
+{
+	if (InSize == 0 || InOffset + InSize > this->Size)
+	{
+		return;
+	}
+
+	const uint64 pageSize = 4096;
+
+#if !defined(KIMURA_UNREAL) && !defined(KIMURA_WINDOWS)
+
+	// let the kernel start reading the whole range ahead of us
+	uint64 alignedOffset = InOffset & ~(pageSize - 1);
+	madvise((void*)(this->Data + alignedOffset), (size_t)(InOffset + InSize - alignedOffset), MADV_WILLNEED);
+
+#endif
+
+	// read one byte per page to force the range to be resident
+	volatile byte sum = 0;
+	for (uint64 offset = InOffset; offset < InOffset + InSize; offset += pageSize)
+	{
+		sum += this->Data[offset];
+	}
+	sum += this->Data[InOffset + InSize - 1];
+}
+
+
+//-----------------------------------------------------------------------------
+// PositionalFile::~PositionalFile
+//-----------------------------------------------------------------------------
+Kimura::PositionalFile::~PositionalFile()
+{
+#if defined(KIMURA_UNREAL)
+
+	if (this->UEFileHandle != nullptr)
+	{
+		delete this->UEFileHandle;
+		this->UEFileHandle = nullptr;
+	}
+
+#elif defined(KIMURA_WINDOWS)
+
+	if (this->FileHandle != nullptr)
+	{
+		CloseHandle(this->FileHandle);
+		this->FileHandle = nullptr;
+	}
+
+#else
+
+	if (this->FileDescriptor != -1)
+	{
+		close(this->FileDescriptor);
+		this->FileDescriptor = -1;
+	}
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// PositionalFile::Open
+//-----------------------------------------------------------------------------
+bool Kimura::PositionalFile::Open(const std::string& InPath)
+{
+#if defined(KIMURA_UNREAL)
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// each reader owns its handle, seeking it doesn't affect anyone else
+	this->UEFileHandle = PlatformFile.OpenRead(*FString(InPath.c_str()));
+
+	return this->UEFileHandle != nullptr;
+
+#elif defined(KIMURA_WINDOWS)
+
+	this->FileHandle = CreateFileA(InPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->FileHandle == INVALID_HANDLE_VALUE)
+	{
+		this->FileHandle = nullptr;
+		return false;
+	}
+
+	return true;
+
+#else
+
+	this->FileDescriptor = open(InPath.c_str(), O_RDONLY);
+
+	return this->FileDescriptor != -1;
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// PositionalFile::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::PositionalFile::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	byte* data = (byte*)OutData;
+
+#if defined(KIMURA_UNREAL)
+
+	if (this->UEFileHandle == nullptr || !this->UEFileHandle->Seek((int64)InOffset))
+	{
+		return false;
+	}
+
+	return this->UEFileHandle->Read(data, (int64)InSize);
+
+#elif defined(KIMURA_WINDOWS)
+
+	while (InSize > 0)
+	{
+		// the offset is specified per read, the file pointer isn't used
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)(InOffset & 0xffffffff);
+		overlapped.OffsetHigh = (DWORD)(InOffset >> 32);
+
+		DWORD sizeToRead = InSize > 0x40000000 ? 0x40000000 : (DWORD)InSize;
+		DWORD sizeRead = 0;
+		if (!ReadFile(this->FileHandle, data, sizeToRead, &sizeRead, &overlapped) || sizeRead == 0)
+		{
+			return false;
+		}
+
+		data += sizeRead;
+		InOffset += sizeRead;
+		InSize -= sizeRead;
+	}
+
+	return true;
+
+#else
+
+	while (InSize > 0)
+	{
+		ssize_t sizeRead = pread(this->FileDescriptor, data, (size_t)InSize, (off_t)InOffset);
+		if (sizeRead <= 0)
+		{
+			if (sizeRead == -1 && errno == EINTR)
+			{
+				continue;
+			}
+
+			return false;
+		}
+
+		data += sizeRead;
+		InOffset += (uint64)sizeRead;
+		InSize -= (uint64)sizeRead;
+	}
+
+	return true;
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// PositionalFile::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::PositionalFile::GetSize()
+{
+#if defined(KIMURA_UNREAL)
+
+	return this->UEFileHandle != nullptr ? (uint64)this->UEFileHandle->Size() : 0;
+
+#elif defined(KIMURA_WINDOWS)
+
+	LARGE_INTEGER fileSize;
+	if (this->FileHandle == nullptr || !GetFileSizeEx(this->FileHandle, &fileSize))
+	{
+		return 0;
+	}
+
+	return (uint64)fileSize.QuadPart;
+
+#else
+
+	struct stat fileStat;
+	if (this->FileDescriptor == -1 || fstat(this->FileDescriptor, &fileStat) != 0)
+	{
+		return 0;
+	}
+
+	return (uint64)fileStat.st_size;
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::Open
+//-----------------------------------------------------------------------------
+bool Kimura::FileByteSource::Open(const std::string& InPath)
+{
+	if (!this->File.Open(InPath))
+	{
+		return false;
+	}
+
+	this->Size = this->File.GetSize();
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::FileByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::FileByteSource::ReadAt(uint64 InPosition, void* OutData, uint64 InSize)
+{
+#if defined(KIMURA_UNREAL)
+	std::unique_lock<std::mutex> readLock(this->ReadMutex);
+#endif
+
+	return this->File.ReadAt(InPosition, OutData, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::MemoryByteSource
+//-----------------------------------------------------------------------------
+Kimura::MemoryByteSource::MemoryByteSource(const void* InData, uint64 InSize, std::shared_ptr<const void> InOwner) :
+	Data((const byte*)InData),
+	Size(InSize),
+	Owner(InOwner)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryByteSource::ReadAt(uint64 InPosition, void* OutData, uint64 InSize)
+{
+	if (InPosition > this->Size || InSize > this->Size - InPosition)
+	{
+		return false;
+	}
+
+	if (InSize > 0)
+	{
+		memcpy(OutData, this->Data + InPosition, (size_t)InSize);
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::GetData
+//-----------------------------------------------------------------------------
+const void* Kimura::MemoryByteSource::GetData()
+{
+	return this->Data;
+}
+
+
+//-----------------------------------------------------------------------------
+// SubRangeByteSource::SubRangeByteSource
+//-----------------------------------------------------------------------------
+Kimura::SubRangeByteSource::SubRangeByteSource(std::shared_ptr<IByteSource> InSource, uint64 InOffset, uint64 InSize) :
+	Source(InSource),
+	Offset(InOffset),
+	Size(InSize)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// SubRangeByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::SubRangeByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// SubRangeByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::SubRangeByteSource::ReadAt(uint64 InPosition, void* OutData, uint64 InSize)
+{
+	// never reads into what lies around the range
+	if (InPosition > this->Size || InSize > this->Size - InPosition)
+	{
+		return false;
+	}
+
+	return this->Source->ReadAt(this->Offset + InPosition, OutData, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// SubRangeByteSource::GetData
+//-----------------------------------------------------------------------------
+const void* Kimura::SubRangeByteSource::GetData()
+{
+	const byte* data = (const byte*)this->Source->GetData();
+
+	return data != nullptr ? data + this->Offset : nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::Get
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::DiskCache> Kimura::DiskCache::Get(const std::string& InDirectory, uint64 InMaxSize)
+{
+	static std::mutex cachesMutex;
+	static std::map<std::string, std::shared_ptr<DiskCache>> caches;
+
+	std::unique_lock<std::mutex> cachesLock(cachesMutex);
+
+	std::string directory;
+	if (!CreateDirectoryTree(InDirectory, directory))
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<DiskCache>& cache = caches[directory];
+	if (cache == nullptr)
+	{
+		std::shared_ptr<DiskCache> newCache = std::make_shared<DiskCache>();
+		if (!newCache->Open(directory))
+		{
+			caches.erase(directory);
+			return nullptr;
+		}
+
+		cache = newCache;
+	}
+
+	// the players opened last decide of the size
+	{
+		std::unique_lock<std::mutex> cacheLock(cache->CacheMutex);
+		cache->MaxSize = InMaxSize;
+		cache->Evict();
+	}
+
+	return cache;
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::GetFileKey
+//-----------------------------------------------------------------------------
+std::string Kimura::DiskCache::GetFileKey(const std::string& InPath)
+{
+	// the full path, and the time the file was last written. The source adds its size.
+#if defined(KIMURA_UNREAL)
+
+	return InPath;
+
+#elif defined(KIMURA_WINDOWS)
+
+	char fullPath[MAX_PATH];
+	if (GetFullPathNameA(InPath.c_str(), MAX_PATH, fullPath, nullptr) == 0)
+	{
+		return InPath;
+	}
+
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(fullPath, GetFileExInfoStandard, &attributes))
+	{
+		return fullPath;
+	}
+
+	uint64 modificationTime = ((uint64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+	return std::string(fullPath) + "|" + std::to_string(modificationTime);
+
+#else
+
+	char fullPath[PATH_MAX];
+	if (realpath(InPath.c_str(), fullPath) == nullptr)
+	{
+		return InPath;
+	}
+
+	struct stat fileStat;
+	if (stat(fullPath, &fileStat) != 0)
+	{
+		return fullPath;
+	}
+
+	return std::string(fullPath) + "|" + std::to_string((int64)fileStat.st_mtime);
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::CreateDirectoryTree
+//-----------------------------------------------------------------------------
+bool Kimura::DiskCache::CreateDirectoryTree(const std::string& InDirectory, std::string& OutFullPath)
+{
+#if defined(KIMURA_UNREAL)
+
+	// the engine caches files its own way
+	return false;
+
+#elif defined(KIMURA_WINDOWS)
+
+	// the directories that already exist fail to be created, only the last one matters
+	for (size_t i = 1; i <= InDirectory.size(); i++)
+	{
+		if (i == InDirectory.size() || InDirectory[i] == '/' || InDirectory[i] == '\\')
+		{
+			CreateDirectoryA(InDirectory.substr(0, i).c_str(), nullptr);
+		}
+	}
+
+	DWORD attributes = GetFileAttributesA(InDirectory.c_str());
+	if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+	{
+		return false;
+	}
+
+	char fullPath[MAX_PATH];
+	if (GetFullPathNameA(InDirectory.c_str(), MAX_PATH, fullPath, nullptr) == 0)
+	{
+		return false;
+	}
+
+	OutFullPath = fullPath;
+
+	return true;
+
+#else
+
+	// the directories that already exist fail to be created, only the last one matters
+	for (size_t i = 1; i <= InDirectory.size(); i++)
+	{
+		if (i == InDirectory.size() || InDirectory[i] == '/')
+		{
+			mkdir(InDirectory.substr(0, i).c_str(), 0755);
+		}
+	}
+
+	char fullPath[PATH_MAX];
+	struct stat directoryStat;
+	if (realpath(InDirectory.c_str(), fullPath) == nullptr || stat(fullPath, &directoryStat) != 0 || !S_ISDIR(directoryStat.st_mode))
+	{
+		return false;
+	}
+
+	OutFullPath = fullPath;
+
+	return true;
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::Open
+//-----------------------------------------------------------------------------
+bool Kimura::DiskCache::Open(const std::string& InDirectory)
+{
+	this->Directory = InDirectory;
+
+	// blocks written last by earlier processes are kept the longest. Blocks left half written a while ago are deleted,
+	// the recent ones may still be written by another process.
+	std::vector<CachedFile> files;
+	std::vector<std::string> temporaryFiles;
+
+#if defined(KIMURA_UNREAL)
+
+	return false;
+
+#elif defined(KIMURA_WINDOWS)
+
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA((InDirectory + "\\*").c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	do
+	{
+		if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+		{
+			continue;
+		}
+
+		CachedFile file;
+		file.Name = findData.cFileName;
+		file.Size = ((uint64)findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+		// 100ns intervals since 1601
+		uint64 writeTime = ((uint64)findData.ftLastWriteTime.dwHighDateTime << 32) | findData.ftLastWriteTime.dwLowDateTime;
+		file.ModificationTime = writeTime / 10000000ull - 11644473600ull;
+		files.push_back(file);
+	}
+	while (FindNextFileA(find, &findData));
+
+	FindClose(find);
+
+	this->ProcessId = (uint32)GetCurrentProcessId();
+
+#else
+
+	DIR* directory = opendir(InDirectory.c_str());
+	if (directory == nullptr)
+	{
+		return false;
+	}
+
+	while (struct dirent* entry = readdir(directory))
+	{
+		struct stat fileStat;
+		if (stat((InDirectory + "/" + entry->d_name).c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+		{
+			continue;
+		}
+
+		CachedFile file;
+		file.Name = entry->d_name;
+		file.Size = (uint64)fileStat.st_size;
+		file.ModificationTime = (uint64)fileStat.st_mtime;
+		files.push_back(file);
+	}
+
+	closedir(directory);
+
+	this->ProcessId = (uint32)getpid();
+
+#endif
+
+	std::sort(files.begin(), files.end(), [](const CachedFile& InA, const CachedFile& InB) { return InA.ModificationTime < InB.ModificationTime; });
+
+	uint64 now = (uint64)time(nullptr);
+
+	for (const CachedFile& file : files)
+	{
+		if (EndsWith(file.Name, ".tmp"))
+		{
+			if (file.ModificationTime + TemporaryFileMaxAge < now)
+			{
+				std::remove((InDirectory + "/" + file.Name).c_str());
+			}
+		}
+		else if (EndsWith(file.Name, ".kcache"))
+		{
+			CachedBlock& block = this->Blocks[file.Name];
+			block.Size = file.Size;
+			block.Use = this->LeastRecentlyUsed.insert(this->LeastRecentlyUsed.end(), file.Name);
+
+			this->Size += file.Size;
+		}
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::EndsWith
+//-----------------------------------------------------------------------------
+bool Kimura::DiskCache::EndsWith(const std::string& InName, const char* InExtension)
+{
+	size_t length = strlen(InExtension);
+	return InName.size() >= length && InName.compare(InName.size() - length, length, InExtension) == 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::Read
+//-----------------------------------------------------------------------------
+bool Kimura::DiskCache::Read(const std::string& InName, uint64 InOffset, void* OutData, uint64 InSize)
+{
+	{
+		std::unique_lock<std::mutex> cacheLock(this->CacheMutex);
+
+		std::map<std::string, CachedBlock>::iterator it = this->Blocks.find(InName);
+		if (it == this->Blocks.end() || InOffset + InSize > it->second.Size)
+		{
+			return false;
+		}
+
+		this->LeastRecentlyUsed.splice(this->LeastRecentlyUsed.end(), this->LeastRecentlyUsed, it->second.Use);
+	}
+
+	// the block may have been evicted in the meantime, it's then read from the source again
+	PositionalFile file;
+	return file.Open(this->Directory + "/" + InName) && file.ReadAt(InOffset, OutData, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::Write
+//-----------------------------------------------------------------------------
+void Kimura::DiskCache::Write(const std::string& InName, const byte* InData, uint64 InSize)
+{
+	std::string path = this->Directory + "/" + InName;
+	std::string temporaryPath = path + "." + std::to_string(this->ProcessId) + "-" + std::to_string(this->NextTemporaryFile++) + ".tmp";
+
+	// readers never see a block partly written. A full disk only means the block isn't cached.
+	{
+		std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+		file.write((const char*)InData, (std::streamsize)InSize);
+		file.close();
+
+		if (file.fail())
+		{
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+	}
+
+	std::unique_lock<std::mutex> cacheLock(this->CacheMutex);
+
+#if defined(KIMURA_WINDOWS)
+	bool bRenamed = MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool bRenamed = std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+
+	if (!bRenamed)
+	{
+		std::remove(temporaryPath.c_str());
+		return;
+	}
+
+	std::map<std::string, CachedBlock>::iterator it = this->Blocks.find(InName);
+	if (it != this->Blocks.end())
+	{
+		// written by another reader at the same time
+		this->Size -= it->second.Size;
+		it->second.Size = InSize;
+		this->LeastRecentlyUsed.splice(this->LeastRecentlyUsed.end(), this->LeastRecentlyUsed, it->second.Use);
+	}
+	else
+	{
+		CachedBlock& block = this->Blocks[InName];
+		block.Size = InSize;
+		block.Use = this->LeastRecentlyUsed.insert(this->LeastRecentlyUsed.end(), InName);
+	}
+
+	this->Size += InSize;
+
+	this->Evict();
+}
+
+
+//-----------------------------------------------------------------------------
+// DiskCache::Evict
+//-----------------------------------------------------------------------------
+void Kimura::DiskCache::Evict()
+{
+	// expects CacheMutex to be locked by the caller
+	while (this->Size > this->MaxSize && !this->LeastRecentlyUsed.empty())
+	{
+		std::string name = this->LeastRecentlyUsed.front();
+		this->LeastRecentlyUsed.pop_front();
+
+		std::map<std::string, CachedBlock>::iterator it = this->Blocks.find(name);
+		this->Size -= it->second.Size;
+		this->Blocks.erase(it);
+
+		std::remove((this->Directory + "/" + name).c_str());
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// CachedByteSource::CachedByteSource
+//-----------------------------------------------------------------------------
+Kimura::CachedByteSource::CachedByteSource(std::shared_ptr<IByteSource> InSource, std::shared_ptr<DiskCache> InCache, const std::string& InKey) :
+	Source(InSource),
+	Cache(InCache),
+	Size(InSource->GetSize())
+{
+	// the key and the size make up the name of the blocks, hashed (FNV-1a) to stay the same from one process to the next
+	std::string key = InKey + "|" + std::to_string(this->Size);
+
+	uint64 hash = 14695981039346656037ull;
+	for (char c : key)
+	{
+		hash = (hash ^ (uint8)c) * 1099511628211ull;
+	}
+
+	char hashText[17];
+	snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)hash);
+	this->KeyHash = hashText;
+}
+
+
+//-----------------------------------------------------------------------------
+// CachedByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::CachedByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// CachedByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::CachedByteSource::ReadAt(uint64 InPosition, void* OutData, uint64 InSize)
+{
+	if (InPosition > this->Size || InSize > this->Size - InPosition)
+	{
+		return false;
+	}
+
+	byte* data = (byte*)OutData;
+	std::vector<byte> block;
+
+	uint64 blockSize = BlockSize;
+
+	while (InSize > 0)
+	{
+		uint64 iBlock = InPosition / blockSize;
+		uint64 offsetInBlock = InPosition - iBlock * blockSize;
+		uint64 sizeInBlock = std::min(InSize, blockSize - offsetInBlock);
+
+		std::string name = this->GetBlockName(iBlock);
+
+		if (!this->Cache->Read(name, offsetInBlock, data, sizeInBlock))
+		{
+			// the whole block is read from the source and cached, for the reads of the rest of it to be served locally
+			uint64 blockPosition = iBlock * blockSize;
+			block.resize((size_t)std::min(blockSize, this->Size - blockPosition));
+
+			if (!this->Source->ReadAt(blockPosition, block.data(), block.size()))
+			{
+				return false;
+			}
+
+			memcpy(data, block.data() + offsetInBlock, (size_t)sizeInBlock);
+
+			this->Cache->Write(name, block.data(), block.size());
+		}
+
+		data += sizeInBlock;
+		InPosition += sizeInBlock;
+		InSize -= sizeInBlock;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// CachedByteSource::GetBlockName
+//-----------------------------------------------------------------------------
+std::string Kimura::CachedByteSource::GetBlockName(uint64 iBlock)
+{
+	char blockText[17];
+	snprintf(blockText, sizeof(blockText), "%08llx", (unsigned long long)iBlock);
+
+	return this->KeyHash + "-" + blockText + ".kcache";
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::ThrottledByteSource
+//-----------------------------------------------------------------------------
+Kimura::ThrottledByteSource::ThrottledByteSource(std::shared_ptr<IByteSource> InSource, const ThrottleSettings& InSettings) :
+	Source(InSource),
+	Settings(InSettings),
+	TransfersEnd(std::chrono::steady_clock::now())
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::ThrottledByteSource::GetSize()
+{
+	return this->Source->GetSize();
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::ThrottledByteSource::ReadAt(uint64 InPosition, void* OutData, uint64 InSize)
+{
+	// already fetched along with the read before it
+	{
+		std::unique_lock<std::mutex> transferLock(this->TransferMutex);
+
+		uint64 firstBlock = InPosition / ReadAheadSize;
+		uint64 lastBlock = (InPosition + std::max(InSize, (uint64)1) - 1) / ReadAheadSize;
+
+		bool bReadAhead = firstBlock == this->LastReadAheadBlock && lastBlock == this->LastReadAheadBlock;
+		this->LastReadAheadBlock = lastBlock;
+
+		if (bReadAhead)
+		{
+			transferLock.unlock();
+			return this->Source->ReadAt(InPosition, OutData, InSize);
+		}
+	}
+
+	// the latency of each read, the reads in flight wait theirs at the same time
+	double latency = this->Settings.LatencyMS;
+
+	if (this->Settings.JitterMS > 0.0f)
+	{
+		double random = this->GetRandom(InPosition, 0);
+
+		if (this->Settings.Jitter == JitterDistribution::Exponential)
+		{
+			latency -= this->Settings.JitterMS * std::log(1.0 - random);
+		}
+		else
+		{
+			latency += this->Settings.JitterMS * 2.0 * random;
+		}
+	}
+
+	if (this->Settings.StallProbability > 0.0f && this->GetRandom(InPosition, 1) < this->Settings.StallProbability)
+	{
+		latency += this->Settings.StallMS;
+	}
+
+	if (latency > 0.0)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(latency));
+	}
+
+	// then the transfer, after the transfers of the reads before it
+	if (this->Settings.BytesPerSecond > 0)
+	{
+		std::chrono::steady_clock::time_point transferEnd;
+		{
+			std::unique_lock<std::mutex> transferLock(this->TransferMutex);
+
+			std::chrono::steady_clock::duration transferTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>((double)InSize / (double)this->Settings.BytesPerSecond));
+
+			this->TransfersEnd = std::max(this->TransfersEnd, std::chrono::steady_clock::now()) + transferTime;
+			transferEnd = this->TransfersEnd;
+		}
+
+		std::this_thread::sleep_until(transferEnd);
+	}
+
+	return this->Source->ReadAt(InPosition, OutData, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::GetRandom
+//-----------------------------------------------------------------------------
+double Kimura::ThrottledByteSource::GetRandom(uint64 InPosition, uint64 InStream)
+{
+	// splitmix64 of the seed, the stream and the position
+	uint64 x = ((uint64)this->Settings.Seed << 32) ^ (InStream << 62) ^ InPosition;
+
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	x = x ^ (x >> 31);
+
+	return (double)(x >> 11) / (double)(1ull << 53);
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::IsThrottling
+//-----------------------------------------------------------------------------
+bool Kimura::ThrottledByteSource::IsThrottling(const ThrottleSettings& InSettings)
+{
+	return InSettings.BytesPerSecond > 0 || InSettings.LatencyMS > 0.0f || InSettings.JitterMS > 0.0f || 
+		(InSettings.StallProbability > 0.0f && InSettings.StallMS > 0.0f);
+}
+
+
+//-----------------------------------------------------------------------------
+// ThrottledByteSource::GetEnvironmentSettings
+//-----------------------------------------------------------------------------
+bool Kimura::ThrottledByteSource::GetEnvironmentSettings(ThrottleSettings& OutSettings)
+{
+	const char* environment = getenv("KIMURA_THROTTLE");
+	if (environment == nullptr)
+	{
+		return false;
+	}
+
+	// comma separated name=value pairs, the names not known are ignored
+	std::string settings = environment;
+	size_t start = 0;
+
+	while (start < settings.size())
+	{
+		size_t end = settings.find(',', start);
+		if (end == std::string::npos)
+		{
+			end = settings.size();
+		}
+
+		std::string setting = settings.substr(start, end - start);
+		start = end + 1;
+
+		size_t equal = setting.find('=');
+		if (equal == std::string::npos)
+		{
+			continue;
+		}
+
+		std::string name = setting.substr(0, equal);
+		const char* value = setting.c_str() + equal + 1;
+
+		if (name == "bandwidth")
+		{
+			OutSettings.BytesPerSecond = strtoull(value, nullptr, 10);
+		}
+		else if (name == "latency")
+		{
+			OutSettings.LatencyMS = (float)atof(value);
+		}
+		else if (name == "jitter")
+		{
+			OutSettings.JitterMS = (float)atof(value);
+		}
+		else if (name == "distribution")
+		{
+			OutSettings.Jitter = strcmp(value, "exponential") == 0 ? JitterDistribution::Exponential : JitterDistribution::Uniform;
+		}
+		else if (name == "stall")
+		{
+			// odds:duration
+			OutSettings.StallProbability = (float)atof(value);
+
+			const char* duration = strchr(value, ':');
+			OutSettings.StallMS = duration != nullptr ? (float)atof(duration + 1) : 0.0f;
+		}
+		else if (name == "seed")
+		{
+			OutSettings.Seed = (uint32)strtoul(value, nullptr, 10);
+		}
+	}
+
+	return IsThrottling(OutSettings);
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::Get
+//-----------------------------------------------------------------------------
+Kimura::Scheduler& Kimura::Scheduler::Get()
+{
+	static Scheduler scheduler;
+	return scheduler;
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::~Scheduler
+//-----------------------------------------------------------------------------
+Kimura::Scheduler::~Scheduler()
+{
+	{
+		std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+		this->StopThreadExecution = true;
+		this->WorkEvent.notify_all();
+	}
+
+	for (std::thread* thread : this->Threads)
+	{
+		thread->join();
+		delete thread;
+	}
+
+	this->Threads.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::SetNumThreads
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::SetNumThreads(uint32 InNumThreads)
+{
+	std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+
+	this->NumThreads = std::max(this->NumThreads, InNumThreads);
+
+	// no worker until the first player shows up
+	if (!this->Threads.empty())
+	{
+		this->StartThreads();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::StartThreads
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::StartThreads()
+{
+	while (this->Threads.size() < this->NumThreads)
+	{
+		this->Threads.push_back(new std::thread(&Scheduler::ThreadExecute, this));
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::Register
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::Register(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+
+	this->StartThreads();
+
+	// the player's first piece of work is its initialization
+	ScheduledPlayer scheduledPlayer;
+	scheduledPlayer.Player_ = InPlayer;
+	this->Players.push_back(scheduledPlayer);
+
+	this->WorkEvent.notify_all();
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::Unregister
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::Unregister(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+
+	for (std::list<ScheduledPlayer>::iterator it = this->Players.begin(); it != this->Players.end(); ++it)
+	{
+		if (it->Player_ == InPlayer)
+		{
+			// the worker done with the player notifies everyone waiting
+			this->WorkEvent.wait(schedulerLock, [it]() { return !it->Busy; });
+
+			this->Players.erase(it);
+			return;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::WakeUp
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::WakeUp(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+
+	for (ScheduledPlayer& scheduledPlayer : this->Players)
+	{
+		if (scheduledPlayer.Player_ == InPlayer)
+		{
+			scheduledPlayer.WorkPending = true;
+			this->WorkEvent.notify_all();
+			return;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::PickNextPlayer
+//-----------------------------------------------------------------------------
+Kimura::Scheduler::ScheduledPlayer* Kimura::Scheduler::PickNextPlayer()
+{
+	ScheduledPlayer* nextPlayer = nullptr;
+	int32 nextPriority = 0;
+	std::chrono::steady_clock::time_point nextDeadline;
+
+	// players being served by another worker are skipped, a player is only ever served by one worker at a time
+	for (ScheduledPlayer& scheduledPlayer : this->Players)
+	{
+		if (!scheduledPlayer.WorkPending || scheduledPlayer.Busy)
+		{
+			continue;
+		}
+
+		int32 priority = scheduledPlayer.Player_->Options.SchedulerPriority;
+		std::chrono::steady_clock::time_point deadline = scheduledPlayer.Player_->GetBufferDeadline();
+
+		if (nextPlayer == nullptr || priority > nextPriority || (priority == nextPriority && deadline < nextDeadline))
+		{
+			nextPlayer = &scheduledPlayer;
+			nextPriority = priority;
+			nextDeadline = deadline;
+		}
+	}
+
+	return nextPlayer;
+}
+
+
+//-----------------------------------------------------------------------------
+// Scheduler::ThreadExecute
+//-----------------------------------------------------------------------------
+void Kimura::Scheduler::ThreadExecute()
+{
+	std::unique_lock<std::mutex> schedulerLock(this->SchedulerMutex);
+
+	while (!this->StopThreadExecution)
+	{
+		ScheduledPlayer* scheduledPlayer = this->PickNextPlayer();
+		if (scheduledPlayer == nullptr)
+		{
+			this->WorkEvent.wait(schedulerLock);
+			continue;
+		}
+
+		// a frame at a time, the most urgent player may have changed by then
+		scheduledPlayer->Busy = true;
+		scheduledPlayer->WorkPending = false;
+
+		schedulerLock.unlock();
+		bool bMoreWork = scheduledPlayer->Player_->ExecuteScheduledWork();
+		schedulerLock.lock();
+
+		scheduledPlayer->Busy = false;
+		scheduledPlayer->WorkPending |= bMoreWork;
+
+		// other workers may now serve this player, and a player waiting to unregister may go
+		this->WorkEvent.notify_all();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Get
+//-----------------------------------------------------------------------------
+Kimura::MemoryBudget& Kimura::MemoryBudget::Get()
+{
+	static MemoryBudget budget;
+	return budget;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::SetLimit
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::SetLimit(uint64 InBytes)
+{
+	this->Limit = InBytes;
+
+	// a larger budget may be all the players waiting for memory need
+	this->NotifyReleased(nullptr);
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::GetUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryBudget::GetUsage()
+{
+	return (uint64)std::max(this->Usage.load(), (int64)0);
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Charge
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::Charge(int64 InBytes)
+{
+	this->Usage += InBytes;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::IsOverBudget
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryBudget::IsOverBudget()
+{
+	uint64 limit = this->Limit.load();
+	return limit > 0 && this->Usage.load() > (int64)limit;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::HasRoomFor
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryBudget::HasRoomFor(uint64 InBytes)
+{
+	uint64 limit = this->Limit.load();
+	return limit == 0 || this->Usage.load() + (int64)InBytes <= (int64)limit;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::IsShortOfMemory
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryBudget::IsShortOfMemory()
+{
+	return this->Shortage.load();
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Register
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::Register(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> budgetLock(this->BudgetMutex);
+
+	BudgetedPlayer budgetedPlayer;
+	budgetedPlayer.Player_ = InPlayer;
+	this->Players.push_back(budgetedPlayer);
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Unregister
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::Unregister(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> budgetLock(this->BudgetMutex);
+
+	for (std::list<BudgetedPlayer>::iterator it = this->Players.begin(); it != this->Players.end(); ++it)
+	{
+		if (it->Player_ == InPlayer)
+		{
+			this->Players.erase(it);
+			return;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Reclaim
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::Reclaim(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> budgetLock(this->BudgetMutex);
+
+	if (!this->IsOverBudget())
+	{
+		// memory was released in the meantime
+		InPlayer->WakeUpBufferThread();
+		return;
+	}
+
+	this->Shortage = true;
+
+	// woken up as soon as a player releases frames
+	bool bReleasesPending = false;
+	for (BudgetedPlayer& budgetedPlayer : this->Players)
+	{
+		if (budgetedPlayer.Player_ == InPlayer)
+		{
+			budgetedPlayer.WaitingForMemory = true;
+		}
+
+		bReleasesPending |= budgetedPlayer.Player_->BackBufferReleaseRequested || budgetedPlayer.Player_->LookAheadShrinkRequested;
+	}
+
+	// the players asked to release frames haven't got to it yet
+	if (bReleasesPending)
+	{
+		return;
+	}
+
+	// the frames playback left behind go first, those of every player
+	if (!this->BackBuffersReleased)
+	{
+		this->BackBuffersReleased = true;
+
+		for (BudgetedPlayer& budgetedPlayer : this->Players)
+		{
+			budgetedPlayer.Player_->BackBufferReleaseRequested = true;
+			budgetedPlayer.Player_->WakeUpBufferThread();
+		}
+
+		return;
+	}
+
+	// then the frames buffered ahead by the lowest priority player, the one with the most of them first. Players more
+	// important than the one waiting are left alone, as are those as important with no more frames than it, and the 
+	// waiting player never gives up its own frames only to buffer them again.
+	BudgetedPlayer* releasingPlayer = nullptr;
+	int32 releasingPriority = 0;
+	uint32 releasingFrames = 0;
+
+	int32 waitingPriority = InPlayer->Options.MemoryPriority;
+	uint32 waitingFrames = (uint32)InPlayer->BufferedFrames.load();
+
+	for (BudgetedPlayer& budgetedPlayer : this->Players)
+	{
+		uint32 numBufferedFrames = (uint32)budgetedPlayer.Player_->BufferedFrames.load();
+		int32 priority = budgetedPlayer.Player_->Options.MemoryPriority;
+
+		if (budgetedPlayer.Player_ == InPlayer || numBufferedFrames <= 1 || priority > waitingPriority || 
+			(priority == waitingPriority && numBufferedFrames <= waitingFrames + 1))
+		{
+			continue;
 		}
 
-		// texture coords
-		switch (tocMesh.TexCoordFormat_)
+		if (releasingPlayer == nullptr || priority < releasingPriority || (priority == releasingPriority && numBufferedFrames > releasingFrames))
 		{
-			case TexCoordFormat::Full:
-			{
-				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
-				{
-					if (tocFrameMesh.SeekTexCoords[iTC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.TexCoordsF32[iTC] = previousFrame->Meshes[iMesh].TexCoordsF32[iTC];
-						}
-					}
-					else if (tocFrameMesh.SizeTexCoords[iTC] > 0)
-					{
-						frameMesh.TexCoordsF32[iTC] = (float*)&bufferAddress[tocFrameMesh.SeekTexCoords[iTC]];
-					}
-				}
+			releasingPlayer = &budgetedPlayer;
+			releasingPriority = priority;
+			releasingFrames = numBufferedFrames;
+		}
+	}
 
-				break;
-			}
+	if (releasingPlayer != nullptr)
+	{
+		releasingPlayer->Player_->LookAheadShrinkRequested = true;
+		releasingPlayer->Player_->WakeUpBufferThread();
+	}
+}
 
-			case TexCoordFormat::Half:
-			{
-				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
-				{
-					if (tocFrameMesh.SeekTexCoords[iTC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.TexCoordsU16[iTC] = previousFrame->Meshes[iMesh].TexCoordsU16[iTC];
-						}
-					}
-					else if (tocFrameMesh.SizeTexCoords[iTC] > 0)
-					{
-						frameMesh.TexCoordsU16[iTC] = (uint16*)&bufferAddress[tocFrameMesh.SeekTexCoords[iTC]];
-					}
-				}
 
-				break;
-			}
+//-----------------------------------------------------------------------------
+// MemoryBudget::NotifyReleased
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::NotifyReleased(Player* InPlayer)
+{
+	std::unique_lock<std::mutex> budgetLock(this->BudgetMutex);
 
-			case TexCoordFormat::None:
-			default:
+	// the next shortage starts over with the frames left behind, and the loop heads they took along are pinned again
+	if (!this->IsOverBudget())
+	{
+		if (this->BackBuffersReleased)
+		{
+			for (BudgetedPlayer& budgetedPlayer : this->Players)
 			{
-				break;
-			}			
-
+				budgetedPlayer.Player_->LoopHeadPinRequested = true;
+				budgetedPlayer.Player_->WakeUpBufferThread();
+			}
 		}
 
+		this->BackBuffersReleased = false;
+		this->Shortage = false;
+	}
 
-		switch (tocMesh.ColorFormat_)
+	for (BudgetedPlayer& budgetedPlayer : this->Players)
+	{
+		if (budgetedPlayer.WaitingForMemory && budgetedPlayer.Player_ != InPlayer)
 		{
-			case ColorFormat::Full:
-			{
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsF32[iCC] = previousFrame->Meshes[iMesh].ColorsF32[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsF32[iCC] = (float*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
-			
-				break;
-			}
-
-			case ColorFormat::Half:
-			{
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsU16[iCC] = previousFrame->Meshes[iMesh].ColorsU16[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsU16[iCC] = (uint16*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
-				break;
-			}
+			budgetedPlayer.WaitingForMemory = false;
+			budgetedPlayer.Player_->WakeUpBufferThread();
+		}
+	}
+}
 
-			case ColorFormat::Byte:
-			case ColorFormat::ByteHDR:
-			{
 
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsU8[iCC] = previousFrame->Meshes[iMesh].ColorsU8[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsU8[iCC] = (uint8*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
+//-----------------------------------------------------------------------------
+// FrameReaderPool::FrameReaderPool
+//-----------------------------------------------------------------------------
+Kimura::FrameReaderPool::FrameReaderPool(Player* InOwner, uint32 InNumThreads) :
+	Owner(InOwner)
+{
+	for (uint32 i = 0; i < InNumThreads; i++)
+	{
+		this->Threads.push_back(new std::thread(&FrameReaderPool::ThreadExecute, this));
+	}
+}
 
-				break;
-			}
 
-			case ColorFormat::None:
-			default:
-			{
-				break;
-			}			
-		}
+//-----------------------------------------------------------------------------
+// FrameReaderPool::~FrameReaderPool
+//-----------------------------------------------------------------------------
+Kimura::FrameReaderPool::~FrameReaderPool()
+{
+	{
+		std::unique_lock<std::mutex> queueLock(this->QueueMutex);
+		this->StopThreadExecution = true;
+		this->QueueEvent.notify_all();
 	}
 
-	// setup the frame's image sequence data
-	newFrame->Images.resize(tocFrame.Images.size());
-	for (uint32 iImageSequence = 0; iImageSequence < newFrame->Images.size(); iImageSequence++)
+	for (std::thread* thread : this->Threads)
 	{
-		// copy number of mipmaps used
-		newFrame->Images[iImageSequence].NumMipmaps = tocFrame.Images[iImageSequence].NumMipmaps;
+		thread->join();
+		delete thread;
+	}
+
+	this->Threads.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameReaderPool::Queue
+//-----------------------------------------------------------------------------
+void Kimura::FrameReaderPool::Queue(std::shared_ptr<FrameRead> InRead)
+{
+	std::unique_lock<std::mutex> queueLock(this->QueueMutex);
+	this->Reads.push_back(InRead);
+	this->QueueEvent.notify_one();
+}
+
 
-		// for each mipmap, store pointer to data + size of data
-		TOCMipmap* pTOCMipmap = tocFrame.Images[iImageSequence].Mipmaps;
-		FrameImageMipmap* pFrameMipmap = newFrame->Images[iImageSequence].Mipmaps;
-		for (uint32 iMipmap = 0; iMipmap < tocFrame.Images[iImageSequence].NumMipmaps; iMipmap++)
+//-----------------------------------------------------------------------------
+// FrameReaderPool::ThreadExecute
+//-----------------------------------------------------------------------------
+void Kimura::FrameReaderPool::ThreadExecute()
+{
+	// all readers share the player's byte source, reads are positional
+	while (true)
+	{
+		std::shared_ptr<FrameRead> read = nullptr;
 		{
-			if (pTOCMipmap->SeekPosition == -1)
-			{
-				if (previousFrame != nullptr)
-				{
-					pFrameMipmap->Data = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Data;
-					pFrameMipmap->Size = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Size;
-				}
-			}
-			else
+			std::unique_lock<std::mutex> queueLock(this->QueueMutex);
+			this->QueueEvent.wait(queueLock, [this]() { return !this->Reads.empty() || this->StopThreadExecution; });
+
+			if (this->StopThreadExecution)
 			{
-				pFrameMipmap->Data = (void*)&bufferAddress[pTOCMipmap->SeekPosition];
-				pFrameMipmap->Size = pTOCMipmap->Size;
+				break;
 			}
 
-			pFrameMipmap++;
-			pTOCMipmap++;
+			read = this->Reads.front();
+			this->Reads.pop_front();
 		}
 
+		this->Owner->ExecuteFrameRead(read);
 	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ExternalFrameReader::ExternalFrameReader
+//-----------------------------------------------------------------------------
+Kimura::ExternalFrameReader::ExternalFrameReader(Player* InOwner) :
+	Owner(InOwner)
+{
+}
 
-	this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond += timeProcessingFrame.Duration();
-	this->Profiling.NumFramesProcessedInLastSecond++;
 
-	// store the frame
+//-----------------------------------------------------------------------------
+// ExternalFrameReader::Queue
+//-----------------------------------------------------------------------------
+void Kimura::ExternalFrameReader::Queue(std::shared_ptr<FrameRead> InRead)
+{
+	std::unique_lock<std::mutex> readsLock(this->ReadsMutex);
+	this->QueuedReads.push_back(InRead);
+}
+
+
+//-----------------------------------------------------------------------------
+// ExternalFrameReader::TakeReads
+//-----------------------------------------------------------------------------
+void Kimura::ExternalFrameReader::TakeReads(std::vector<ExternalRead>& OutReads)
+{
+	std::unique_lock<std::mutex> readsLock(this->ReadsMutex);
+
+	while (!this->QueuedReads.empty())
 	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
-		this->Frames[iFrame] = newFrame;
-	}
+		std::shared_ptr<FrameRead> read = this->QueuedReads.front();
+		this->QueuedReads.pop_front();
+
+		// reads made obsolete by a jump elsewhere in the playback aren't handed over
+		if (!this->Owner->IsFrameReadCurrent(*read))
+		{
+			continue;
+		}
+
+		// buffers are only prepared now, the host might take its time to come for the reads
+		ExternalRead externalRead;
+		externalRead.Id = this->NextReadId++;
+		externalRead.FrameIndex = read->Frame_->FrameIndex;
+		externalRead.Destination = this->Owner->PrepareFrameBuffer(*read->Frame_, externalRead.FilePosition, externalRead.Size);
 
+		if (externalRead.Destination == nullptr && externalRead.Size > 0)
+		{
+			this->Owner->Failure("Failed to allocate frame buffer");
+			continue;
+		}
+
+		TakenRead& takenRead = this->TakenReads[externalRead.Id];
+		takenRead.Read = read;
+		takenRead.Size = externalRead.Size;
+		takenRead.TakeTime = std::chrono::steady_clock::now();
+
+		OutReads.push_back(externalRead);
+	}
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::GetNumFrames
+// ExternalFrameReader::CompleteRead
 //-----------------------------------------------------------------------------
-Kimura::uint32 Kimura::Player::GetNumFrames()
+void Kimura::ExternalFrameReader::CompleteRead(uint64 InReadId, bool InSucceeded)
 {
-	if (this->Status != Kimura::PlayerStatus::Ready)
+	TakenRead takenRead;
 	{
-		return 0;
+		std::unique_lock<std::mutex> readsLock(this->ReadsMutex);
+
+		auto it = this->TakenReads.find(InReadId);
+		if (it == this->TakenReads.end())
+		{
+			return;
+		}
+
+		takenRead = it->second;
+		this->TakenReads.erase(it);
 	}
 
-	return (Kimura::uint32)this->Frames.size();
+	if (!InSucceeded)
+	{
+		this->Owner->Failure("Failed to read frame data from file");
+		return;
+	}
+
+	// the time spent in the host's hands stands for the read time
+	this->Owner->RecordFrameRead(takenRead.Size, std::chrono::duration<double>(std::chrono::steady_clock::now() - takenRead.TakeTime).count());
+
+	this->Owner->CompleteFrameRead(takenRead.Read);
 }
 
 
+#if defined(KIMURA_IO_URING)
+
 //-----------------------------------------------------------------------------
-// Player::GetFrameAt
+// AsyncFrameReader::AsyncFrameReader
 //-----------------------------------------------------------------------------
-std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameAt(uint32 iFrame, bool InForceWait)
+Kimura::AsyncFrameReader::AsyncFrameReader(Player* InOwner, uint32 InQueueDepth) :
+	Owner(InOwner),
+	QueueDepth(InQueueDepth)
 {
-	std::shared_ptr<Kimura::IFrame> r = nullptr;
+}
 
-	uint32 numFramesTotal = (uint32)this->Frames.size();
 
-	// expected that the frame index be within the full range of the playback
-	if (iFrame >= numFramesTotal)
+//-----------------------------------------------------------------------------
+// AsyncFrameReader::~AsyncFrameReader
+//-----------------------------------------------------------------------------
+Kimura::AsyncFrameReader::~AsyncFrameReader()
+{
+	if (this->Thread != nullptr)
 	{
-		// complain
-		return nullptr;
+		std::unique_lock<std::mutex> submitLock(this->SubmitMutex);
+
+		// the kernel still writes into the frame buffers of the reads in flight, wait for all of them to come
+		// back before stopping the completion thread
+		this->Stopping = true;
+		this->Backlog.clear();
+		this->SlotFreedEvent.wait(submitLock, [this]() { return this->FreeSlots.size() == this->QueueDepth; });
+
+		// a no-op with no slot attached tells the completion thread to stop
+		this->Submit(IORING_OP_NOP, 0, 0, nullptr, 0);
+		submitLock.unlock();
+
+		this->Thread->join();
+		delete this->Thread;
+		this->Thread = nullptr;
 	}
 
-	// special case when 'buffer entire playback' is on
-	if (this->Options.BufferEntirePlayback)
+	if (this->SubmissionEntries != nullptr)
 	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
-
-		bool bFrameBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
-		bFrameBuffered |= ((iFrame + numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame + numFramesTotal) < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
+		munmap(this->SubmissionEntries, this->SubmissionEntriesSize);
+	}
 
-		if (bFrameBuffered)
-		{
-			return this->Frames[iFrame];
-		}
+	if (this->CompletionRing != nullptr && this->CompletionRing != this->SubmissionRing)
+	{
+		munmap(this->CompletionRing, this->CompletionRingSize);
+	}
 
+	if (this->SubmissionRing != nullptr)
+	{
+		munmap(this->SubmissionRing, this->SubmissionRingSize);
 	}
-	else
+
+	if (this->RingFileDescriptor != -1)
 	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		close(this->RingFileDescriptor);
+	}
 
-		// first, is this frame buffered? or in queue to be buffered?
-		bool bFrameBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
-		bFrameBuffered |= ((iFrame+numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame+numFramesTotal)< this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
+	if (this->FileDescriptor != -1)
+	{
+		close(this->FileDescriptor);
+	}
+}
 
-		bool bFrameIntentedToBeBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->Options.PreBufferingSize);
-		bFrameIntentedToBeBuffered |= ((iFrame+numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame + numFramesTotal) < this->FullyBufferedFramesStart + this->Options.PreBufferingSize);
 
-		if (bFrameBuffered)
-		{
+//-----------------------------------------------------------------------------
+// AsyncFrameReader::Open
+//-----------------------------------------------------------------------------
+bool Kimura::AsyncFrameReader::Open(const std::string& InPath)
+{
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
 
-			//std::printf("Obtaining frame %d\n", iFrame);
+	if (this->QueueDepth == 0)
+	{
+		return false;
+	}
 
-			// this is the frame we want to return
-			r = this->Frames[iFrame];
+	this->FileDescriptor = open(InPath.c_str(), O_RDONLY);
+	if (this->FileDescriptor == -1)
+	{
+		return false;
+	}
 
-			// remove previous frames 
-			if (!this->Options.BufferEntirePlayback)
-			{
-				while (this->FullyBufferedFramesStart != iFrame)
-				{
-					//std::printf("Removing frame %d\n", this->FullyBufferedFramesStart);
+	// one extra entry for the no-op used to stop the completion thread
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
 
-					// adjust memory footprint
-					if (this->Frames[this->FullyBufferedFramesStart] != nullptr)
-					{
-						this->Profiling.MemoryUsageForFrames -= (uint64)this->Frames[this->FullyBufferedFramesStart]->Buffer.size();
-					}
+	this->RingFileDescriptor = (int)syscall(__NR_io_uring_setup, this->QueueDepth + 1, &params);
+	if (this->RingFileDescriptor < 0)
+	{
+		// not supported by the kernel, or not allowed in this process
+		this->RingFileDescriptor = -1;
+		return false;
+	}
 
-					this->Frames[this->FullyBufferedFramesStart] = nullptr;
-					this->FullyBufferedFramesStart++;
-					this->FullyBufferedFramesStart %= numFramesTotal;
+	// reads with a plain buffer (IORING_OP_READ) are only available from 5.6, which also introduced the probe
+	{
+		std::vector<byte> probeStorage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+		io_uring_probe* probe = (io_uring_probe*)probeStorage.data();
 
-					this->FullyBufferedFramesCount--;
-				}
-			}
-		}
-		else if (bFrameIntentedToBeBuffered)
+		if (syscall(__NR_io_uring_register, this->RingFileDescriptor, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+			probe->last_op < IORING_OP_READ || 
+			!(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
 		{
-			// frame isn't loaded at this time but the player is already working to get there. Do nothing.
-			//std::printf("Frame %d isn't available yet but will be. Waiting...\n", iFrame);
+			return false;
 		}
-		else
-		{
-
-			//std::printf("Requesting frame from non-buffered section. Clearing %d buffered frames and jumping to frame %d \n", this->FullyBufferedFramesCount, iFrame);
+	}
 
-			// clear all buffered frames
-			while (this->FullyBufferedFramesCount > 0)
-			{
-				// adjust memory footprint
-				if (this->Frames[this->FullyBufferedFramesStart] != nullptr)
-				{
-					this->Profiling.MemoryUsageForFrames -= this->Frames[this->FullyBufferedFramesStart]->Buffer.size();
-				}
+	// map the rings shared with the kernel
+	this->SubmissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+	this->CompletionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
 
-				this->Frames[this->FullyBufferedFramesStart] = nullptr;
-				this->FullyBufferedFramesStart++;
-				this->FullyBufferedFramesStart %= numFramesTotal;
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		this->SubmissionRingSize = this->SubmissionRingSize > this->CompletionRingSize ? this->SubmissionRingSize : this->CompletionRingSize;
+		this->CompletionRingSize = this->SubmissionRingSize;
+	}
 
-				this->FullyBufferedFramesCount--;
-			}
+	void* submissionRing = mmap(nullptr, this->SubmissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFileDescriptor, IORING_OFF_SQ_RING);
+	if (submissionRing == MAP_FAILED)
+	{
+		return false;
+	}
+	this->SubmissionRing = submissionRing;
 
-			// set new buffer start 
-			this->FullyBufferedFramesStart = iFrame;
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		this->CompletionRing = this->SubmissionRing;
+	}
+	else
+	{
+		void* completionRing = mmap(nullptr, this->CompletionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFileDescriptor, IORING_OFF_CQ_RING);
+		if (completionRing == MAP_FAILED)
+		{
+			return false;
 		}
+		this->CompletionRing = completionRing;
+	}
 
+	this->SubmissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* submissionEntries = mmap(nullptr, this->SubmissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFileDescriptor, IORING_OFF_SQES);
+	if (submissionEntries == MAP_FAILED)
+	{
+		return false;
+	}
+	this->SubmissionEntries = (io_uring_sqe*)submissionEntries;
+
+	byte* sq = (byte*)this->SubmissionRing;
+	this->SubmissionTail = (uint32*)(sq + params.sq_off.tail);
+	this->SubmissionMask = (uint32*)(sq + params.sq_off.ring_mask);
+	this->SubmissionArray = (uint32*)(sq + params.sq_off.array);
+
+	byte* cq = (byte*)this->CompletionRing;
+	this->CompletionHead = (uint32*)(cq + params.cq_off.head);
+	this->CompletionTail = (uint32*)(cq + params.cq_off.tail);
+	this->CompletionMask = (uint32*)(cq + params.cq_off.ring_mask);
+	this->CompletionEntries = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	// one slot per read in flight
+	this->Slots.resize(this->QueueDepth);
+	for (uint32 i = 0; i < this->QueueDepth; i++)
+	{
+		this->FreeSlots.push_back(this->QueueDepth - 1 - i);
 	}
 
-	// wake up the player's thread and look for more work to do. 
-	this->WakeUpBufferThreadEvent.notify_one();
+	this->Thread = new std::thread(&AsyncFrameReader::ThreadExecute, this);
 
-	// This will force blocking until the desired frame is ready
-	while (r == nullptr && InForceWait)
-	{
-		// wait until a frame has been obtained
-		std::unique_lock<std::mutex> threadLock(this->WaitForFrameBufferedMutex);
-		this->WaitForFrameBufferedEvent.wait(threadLock);
+	return true;
 
-		// *try* to get the frame but do not wait this time
-		r = this->GetFrameAt(iFrame, false);
+#else
 
-	}
+	return false;
 
-	return r;
+#endif
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::GetConstantFrame
+// AsyncFrameReader::Queue
 //-----------------------------------------------------------------------------
-std::shared_ptr<Kimura::IFrame> Kimura::Player::GetConstantFrame()
+void Kimura::AsyncFrameReader::Queue(std::shared_ptr<FrameRead> InRead)
 {
-	return this->FirstFrame;
+	std::unique_lock<std::mutex> submitLock(this->SubmitMutex);
+
+	// reads discarded by the player may still be in flight, in which case this one waits for a free slot
+	if (this->FreeSlots.empty())
+	{
+		this->Backlog.push_back(InRead);
+		return;
+	}
+
+	uint32 slot = this->FreeSlots.back();
+	this->FreeSlots.pop_back();
+
+	this->StartRead(slot, InRead);
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::IsForcing16BitIndices
+// AsyncFrameReader::StartRead
 //-----------------------------------------------------------------------------
-bool Kimura::Player::IsForcing16BitIndices()
+void Kimura::AsyncFrameReader::StartRead(uint32 InSlot, std::shared_ptr<FrameRead> InRead)
 {
-	return this->TOC.Force16BitIndices;
+	AsyncRead& asyncRead = this->Slots[InSlot];
+
+	asyncRead.Read = InRead;
+	asyncRead.Data = this->Owner->PrepareFrameBuffer(*InRead->Frame_, asyncRead.Position, asyncRead.Remaining);
+	asyncRead.SubmitTime = std::chrono::steady_clock::now();
+
+	if (asyncRead.Data == nullptr && asyncRead.Remaining > 0)
+	{
+		this->Owner->Failure("Failed to allocate frame buffer");
+
+		asyncRead.Read = nullptr;
+		this->FreeSlots.push_back(InSlot);
+		return;
+	}
+
+	this->SubmitRead(InSlot);
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::RetrievePlaybackInformation
+// AsyncFrameReader::SubmitRead
 //-----------------------------------------------------------------------------
-bool Kimura::Player::RetrievePlaybackInformation(PlaybackInformation& OutInfo)
+void Kimura::AsyncFrameReader::SubmitRead(uint32 InSlot)
 {
-	if (this->Status != PlayerStatus::Ready)
-	{
-		return false;
-	}
-
-	OutInfo.FrameRate = this->TOC.FrameRate;
-	OutInfo.TimePerFrame = this->TOC.TimePerFrame;
-	OutInfo.FrameCount = (uint32) this->TOC.Frames.size();
-	OutInfo.Duration = OutInfo.FrameCount * OutInfo.TimePerFrame;
+	AsyncRead& asyncRead = this->Slots[InSlot];
 
-	OutInfo.Meshes.resize(this->TOC.Meshes.size());
-	for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
+	if (asyncRead.Remaining == 0)
 	{
-		OutInfo.Meshes[iMesh].Index = iMesh;
-		OutInfo.Meshes[iMesh].Name = this->TOC.Meshes[iMesh].Name;
-		OutInfo.Meshes[iMesh].MaximumVertices = this->TOC.Meshes[iMesh].MaxVertices;
-		OutInfo.Meshes[iMesh].MaximumSurfaces= this->TOC.Meshes[iMesh].MaxSurfaces;
-		OutInfo.Meshes[iMesh].Force16BitIndices = this->TOC.Force16BitIndices;
-		OutInfo.Meshes[iMesh].PositionFormat_ = this->TOC.Meshes[iMesh].PositionFormat_;
-		OutInfo.Meshes[iMesh].NormalFormat_ = this->TOC.Meshes[iMesh].NormalFormat_;
-		OutInfo.Meshes[iMesh].TangentFormat_ = this->TOC.Meshes[iMesh].TangentFormat_;
-		OutInfo.Meshes[iMesh].VelocityFormat_ = this->TOC.Meshes[iMesh].VelocityFormat_;
-		OutInfo.Meshes[iMesh].TexCoordFormat_ = this->TOC.Meshes[iMesh].TexCoordFormat_;
-		OutInfo.Meshes[iMesh].ColorFormat_ = this->TOC.Meshes[iMesh].ColorFormat_;
+		// frames made entirely of data from previous frames have nothing to read. Still go through the ring
+		// so that they complete like every other read.
+		this->Submit(IORING_OP_NOP, InSlot + 1, 0, nullptr, 0);
+		return;
 	}
 
-	OutInfo.ImageSequences.resize(this->TOC.ImageSequences.size());
-	for (uint32 i = 0; i < this->TOC.ImageSequences.size(); i++)
-	{
-		OutInfo.ImageSequences[i].Index = i;
-		OutInfo.ImageSequences[i].Name = this->TOC.ImageSequences[i].Name;
-		OutInfo.ImageSequences[i].Constant = this->TOC.ImageSequences[i].Constant;
-		OutInfo.ImageSequences[i].Width = this->TOC.ImageSequences[i].Width;
-		OutInfo.ImageSequences[i].Height = this->TOC.ImageSequences[i].Height;
-		OutInfo.ImageSequences[i].Mipmaps = this->TOC.ImageSequences[i].MipMapCount;
-		switch (this->TOC.ImageSequences[i].Format)
-		{
-			case ImageFormat::RGBA8:
-			{
-				OutInfo.ImageSequences[i].Format = "RGBA8";
-				break;
-			}
+	// read into the frame pool's buffers as they are. They aren't registered with the ring (IORING_OP_READ_FIXED): the
+	// pool grows and shrinks with playback, while registered buffers are a fixed table pinned against the memlock limit.
+	// A single read is limited to 2GB, larger frames are completed through short reads.
+	uint32 size = asyncRead.Remaining > 0x7ffff000 ? 0x7ffff000 : (uint32)asyncRead.Remaining;
 
-			case ImageFormat::DXT1:
-			{
-				OutInfo.ImageSequences[i].Format = "DXT1";
-				break;
-			}
+	this->Submit(IORING_OP_READ, InSlot + 1, asyncRead.Position, asyncRead.Data, size);
+}
 
-			case ImageFormat::DXT3:
-			{
-				OutInfo.ImageSequences[i].Format = "DXT3";
-				break;
-			}
 
-			case ImageFormat::DXT5:
-			{
-				OutInfo.ImageSequences[i].Format = "DXT5";
-				break;
-			}
+//-----------------------------------------------------------------------------
+// AsyncFrameReader::Submit
+//-----------------------------------------------------------------------------
+void Kimura::AsyncFrameReader::Submit(uint8 InOpcode, uint64 InUserData, uint64 InPosition, byte* InData, uint32 InSize)
+{
+	// entries are submitted one at a time, right away, so the ring never holds more than the reads in flight
+	uint32 tail = *this->SubmissionTail;
+	uint32 index = tail & *this->SubmissionMask;
 
-		}
+	io_uring_sqe* sqe = &this->SubmissionEntries[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
 
-	}
+	sqe->opcode = InOpcode;
+	sqe->fd = InOpcode == IORING_OP_NOP ? -1 : this->FileDescriptor;
+	sqe->off = InPosition;
+	sqe->addr = (uint64)(uintptr_t)InData;
+	sqe->len = InSize;
+	sqe->user_data = InUserData;
 
-	return true;
+	this->SubmissionArray[index] = index;
 
+	// make the entry visible to the kernel before the new tail
+	__atomic_store_n(this->SubmissionTail, tail + 1, __ATOMIC_RELEASE);
+
+	while (syscall(__NR_io_uring_enter, this->RingFileDescriptor, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR)
+	{
+	}
 }
 
 
 //-----------------------------------------------------------------------------
-// Frame::CollectStats
+// AsyncFrameReader::ThreadExecute
 //-----------------------------------------------------------------------------
-void Kimura::Player::CollectStats(PlayerStats& OutStats)
+void Kimura::AsyncFrameReader::ThreadExecute()
 {
+	bool bStop = false;
 
-	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
-	if (now > this->NextStatsCollection)
+	while (!bStop)
 	{
-		std::unique_lock<std::mutex> threadLock(this->ProfilingMutex);
+		// wait for at least one completion
+		if (syscall(__NR_io_uring_enter, this->RingFileDescriptor, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+		{
+			this->Owner->Failure("Failed to wait for asynchronous reads");
+			break;
+		}
 
-		this->StoredProfiling.BytesReadInLastSecond = this->Profiling.BytesReadInLastSecond;
-		this->StoredProfiling.MemoryUsageForFrames = this->Profiling.MemoryUsageForFrames;
+		uint32 head = *this->CompletionHead;
+		uint32 tail = __atomic_load_n(this->CompletionTail, __ATOMIC_ACQUIRE);
 
-		// update stats
-		this->StoredProfiling.AvgTimeSpentOnReadingFromDiskPerFrame = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
-		this->StoredProfiling.AvgTimeSpentOnProcessingPerFrames = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
-		this->StoredProfiling.TotalTimeSpentOnReadingFromDiskInLastSecond = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond;
-		this->StoredProfiling.TotalTimeSpentOnProcessingFramesInLastSecond = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond;
-		this->StoredProfiling.NumFramesProcessedInLastSecond = this->Profiling.NumFramesProcessedInLastSecond;
+		for (; head != tail; head++)
+		{
+			io_uring_cqe& cqe = this->CompletionEntries[head & *this->CompletionMask];
 
-		this->Profiling.BytesReadInLastSecond = 0;
-		this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond = 0;
-		this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond = 0;
-		this->Profiling.NumFramesProcessedInLastSecond = 0;
+			if (cqe.user_data == 0)
+			{
+				bStop = true;
+				continue;
+			}
 
-		// c++ 14
-		//using namespace std::literals;
-		//this->NextStatsCollection = now + 1s;
+			uint32 slot = (uint32)cqe.user_data - 1;
+			int result = cqe.res;
 
-		// c++ 11
-		this->NextStatsCollection = now + std::chrono::seconds{1};
+			std::shared_ptr<FrameRead> completedRead = nullptr;
+			uint64 bytesRead = 0;
+			double duration = 0.0;
+			{
+				std::unique_lock<std::mutex> submitLock(this->SubmitMutex);
 
-	}
+				AsyncRead& asyncRead = this->Slots[slot];
 
-	OutStats = this->StoredProfiling;
+				if ((result == -EINTR || result == -EAGAIN) && !this->Stopping)
+				{
+					// try again
+					this->SubmitRead(slot);
+					continue;
+				}
+
+				if (this->Stopping && (result < 0 || asyncRead.Remaining > (uint64)result))
+				{
+					// interrupted by the destruction, the frame won't be used
+				}
+				else if (result < 0 || (result == 0 && asyncRead.Remaining > 0))
+				{
+					this->Owner->Failure("Failed to read frame data from file");
+				}
+				else
+				{
+					asyncRead.Data += result;
+					asyncRead.Position += (uint64)result;
+					asyncRead.Remaining -= (uint64)result;
 
-	OutStats.BufferedFramesStart = this->FullyBufferedFramesStart;
-	OutStats.BufferedFramesCount = this->FullyBufferedFramesCount;
+					if (asyncRead.Remaining > 0)
+					{
+						// short read, queue the rest
+						this->SubmitRead(slot);
+						continue;
+					}
 
+					completedRead = asyncRead.Read;
+					bytesRead = completedRead->Frame_->BufferSize;
+					duration = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - asyncRead.SubmitTime).count();
+				}
 
-}
+				asyncRead.Read = nullptr;
+				asyncRead.Data = nullptr;
 
+				// the slot is free again, start the next read waiting for one (if still needed)
+				bool bSlotReused = false;
+				while (!this->Backlog.empty() && !bSlotReused)
+				{
+					std::shared_ptr<FrameRead> nextRead = this->Backlog.front();
+					this->Backlog.pop_front();
 
-//-----------------------------------------------------------------------------
-// Frame::GetBufferedFrameCount
-//-----------------------------------------------------------------------------
-int Kimura::Player::GetBufferedFrameCount()
-{
-	return this->FullyBufferedFramesCount;
+					if (this->Owner->IsFrameReadCurrent(*nextRead))
+					{
+						this->StartRead(slot, nextRead);
+						bSlotReused = true;
+					}
+				}
+
+				if (!bSlotReused)
+				{
+					this->FreeSlots.push_back(slot);
+					this->SlotFreedEvent.notify_all();
+				}
+			}
+
+			if (completedRead != nullptr)
+			{
+				this->Owner->RecordFrameRead(bytesRead, duration);
+				this->Owner->CompleteFrameRead(completedRead);
+			}
+		}
+
+		__atomic_store_n(this->CompletionHead, head, __ATOMIC_RELEASE);
+	}
 }
 
+#endif
+
 
 //-----------------------------------------------------------------------------
 // Frame::GetIndicesU16
@@ -1901,6 +8027,175 @@ void Kimura::Frame::GetBounds(uint32 InMeshIndex, Vector3& OutCenter, Vector3& O
 }
 
 
+//-----------------------------------------------------------------------------
+// FrameMesh::GetAttributeData
+//-----------------------------------------------------------------------------
+const Kimura::byte* Kimura::FrameMesh::GetAttributeData(uint32 InAttribute) const
+{
+	switch (InAttribute)
+	{
+		case MeshAttribute_Indices:
+			return this->IndicesU16 != nullptr ? (const byte*)this->IndicesU16 : (const byte*)this->IndicesU32;
+
+		case MeshAttribute_Positions:
+			return this->PositionsF32 != nullptr ? (const byte*)this->PositionsF32 : (const byte*)this->PositionsI16;
+
+		case MeshAttribute_Normals:
+			return this->NormalsF32 != nullptr ? (const byte*)this->NormalsF32 : this->NormalsI16 != nullptr ? (const byte*)this->NormalsI16 : (const byte*)this->NormalsI8;
+
+		case MeshAttribute_Tangents:
+			return this->TangentsF32 != nullptr ? (const byte*)this->TangentsF32 : this->TangentsI16 != nullptr ? (const byte*)this->TangentsI16 : (const byte*)this->TangentsI8;
+
+		case MeshAttribute_Velocities:
+			return this->VelocitiesF32 != nullptr ? (const byte*)this->VelocitiesF32 : this->VelocitiesI16 != nullptr ? (const byte*)this->VelocitiesI16 : (const byte*)this->VelocitiesI8;
+	}
+
+	if (InAttribute >= MeshAttribute_TexCoords && InAttribute < MeshAttribute_TexCoords + MaxTextureCoords)
+	{
+		uint32 iTexCoord = InAttribute - MeshAttribute_TexCoords;
+		return this->TexCoordsF32[iTexCoord] != nullptr ? (const byte*)this->TexCoordsF32[iTexCoord] : (const byte*)this->TexCoordsU16[iTexCoord];
+	}
+
+	if (InAttribute >= MeshAttribute_Colors && InAttribute < MeshAttribute_Colors + MaxColorChannels)
+	{
+		uint32 iColor = InAttribute - MeshAttribute_Colors;
+		return this->ColorsF32[iColor] != nullptr ? (const byte*)this->ColorsF32[iColor] : this->ColorsU16[iColor] != nullptr ? (const byte*)this->ColorsU16[iColor] : (const byte*)this->ColorsU8[iColor];
+	}
+
+	return nullptr;
+}
+
+
+namespace Kimura
+{
+	template<typename T>
+	inline void RedirectAttribute(const T*& InOutPointer, const byte* InData)
+	{
+		if (InOutPointer != nullptr)
+		{
+			InOutPointer = (const T*)InData;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// FrameMesh::SetAttributeData
+//-----------------------------------------------------------------------------
+void Kimura::FrameMesh::SetAttributeData(uint32 InAttribute, const byte* InData)
+{
+	switch (InAttribute)
+	{
+		case MeshAttribute_Indices:
+			RedirectAttribute(this->IndicesU16, InData);
+			RedirectAttribute(this->IndicesU32, InData);
+			return;
+
+		case MeshAttribute_Positions:
+			RedirectAttribute(this->PositionsF32, InData);
+			RedirectAttribute(this->PositionsI16, InData);
+			return;
+
+		case MeshAttribute_Normals:
+			RedirectAttribute(this->NormalsF32, InData);
+			RedirectAttribute(this->NormalsI16, InData);
+			RedirectAttribute(this->NormalsI8, InData);
+			return;
+
+		case MeshAttribute_Tangents:
+			RedirectAttribute(this->TangentsF32, InData);
+			RedirectAttribute(this->TangentsI16, InData);
+			RedirectAttribute(this->TangentsI8, InData);
+			return;
+
+		case MeshAttribute_Velocities:
+			RedirectAttribute(this->VelocitiesF32, InData);
+			RedirectAttribute(this->VelocitiesI16, InData);
+			RedirectAttribute(this->VelocitiesI8, InData);
+			return;
+	}
+
+	if (InAttribute >= MeshAttribute_TexCoords && InAttribute < MeshAttribute_TexCoords + MaxTextureCoords)
+	{
+		uint32 iTexCoord = InAttribute - MeshAttribute_TexCoords;
+		RedirectAttribute(this->TexCoordsF32[iTexCoord], InData);
+		RedirectAttribute(this->TexCoordsU16[iTexCoord], InData);
+	}
+	else if (InAttribute >= MeshAttribute_Colors && InAttribute < MeshAttribute_Colors + MaxColorChannels)
+	{
+		uint32 iColor = InAttribute - MeshAttribute_Colors;
+		RedirectAttribute(this->ColorsF32[iColor], InData);
+		RedirectAttribute(this->ColorsU16[iColor], InData);
+		RedirectAttribute(this->ColorsU8[iColor], InData);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Frame::Reset
+//-----------------------------------------------------------------------------
+void Kimura::Frame::Reset()
+{
+	this->FrameIndex = 0;
+	this->ReadTimeInMS = 0.0;
+	this->ProcessTimeInMS = 0.0;
+
+	this->Mapping = nullptr;
+	this->FrameData = nullptr;
+	this->TOCPage = nullptr;
+	this->BufferSize = 0;
+
+	this->Selection = nullptr;
+	this->DataRanges.clear();
+
+	this->ImagesPending = false;
+	this->ImagesPreviousFrame = nullptr;
+	this->ImageDependencies.clear();
+
+	for (FrameMesh& frameMesh : this->Meshes)
+	{
+		std::vector<TOCFrameMeshSection> sections;
+		sections.swap(frameMesh.Sections);
+		sections.clear();
+
+		frameMesh = FrameMesh();
+		frameMesh.Sections.swap(sections);
+	}
+
+	for (FrameImage& frameImage : this->Images)
+	{
+		frameImage = FrameImage();
+	}
+
+	this->ForwardedData.clear();
+	this->FrameDependencies.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+// Frame::GetBufferOffset
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Frame::GetBufferOffset(uint32 InSeek) const
+{
+	if (this->DataRanges.empty())
+	{
+		return InSeek;
+	}
+
+	// last range starting at or before the data
+	auto range = std::upper_bound(this->DataRanges.begin(), this->DataRanges.end(), InSeek, 
+		[](uint32 InOffset, const FrameDataRange& InRange) { return InOffset < InRange.Offset; });
+
+	if (range == this->DataRanges.begin())
+	{
+		return 0;
+	}
+
+	--range;
+
+	return range->BufferOffset + (InSeek - range->Offset);
+}
+
+
 //-----------------------------------------------------------------------------
 // Frame::GetNumVertices
 //-----------------------------------------------------------------------------
@@ -1973,6 +8268,14 @@ bool Kimura::Frame::GetImageData(uint32 InImageIndex, uint32 InMipmap, const voi
 		return false;
 	}
 
+	// images read after the frame was handed out (PlayerOptions::LowPriorityImages) aren't there yet
+	if (this->ImagesPending)
+	{
+		OutSize = 0;
+		*OutData = nullptr;
+		return false;
+	}
+
 	if (InMipmap >= this->Images[InImageIndex].NumMipmaps)
 	{
 		OutSize = 0;
@@ -1983,7 +8286,8 @@ bool Kimura::Frame::GetImageData(uint32 InImageIndex, uint32 InMipmap, const voi
 	*OutData = this->Images[InImageIndex].Mipmaps[InMipmap].Data;
 	OutSize = this->Images[InImageIndex].Mipmaps[InMipmap].Size;
 
-	return true;
+	// mipmaps not loaded (PlayerOptions::MinimumImageMipmaps)
+	return *OutData != nullptr;
 
 }
 
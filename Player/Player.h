@@ -12,6 +12,13 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 #include "Kimura.h"
 
@@ -27,8 +34,16 @@
 
 #else
 
-	// default input stream
-	#include <fstream>
+	// asynchronous reads through io_uring, whenever the kernel headers provide it
+	#if defined(__linux__) && defined(__has_include)
+		#if __has_include(<linux/io_uring.h>)
+			#define KIMURA_IO_URING 1
+
+			// from linux/io_uring.h, only included by the player's implementation
+			struct io_uring_sqe;
+			struct io_uring_cqe;
+		#endif
+	#endif
 
 	#define KIMURA_TRACE(x)
 
@@ -40,10 +55,13 @@ namespace Kimura
 	struct Version
 	{
 		uint8 A = 0;
-		uint8 B = 5;
+		uint8 B = 6;
 		uint8 C = 0;
 		uint8 NotUsed = 0;
 
+		Version() {}
+		Version(uint8 InA, uint8 InB, uint8 InC) : A(InA), B(InB), C(InC) {}
+
 		bool SameAs(Version other)
 		{
 			return this->A == other.A && this->B == other.B && this->C == other.C;
@@ -66,6 +84,9 @@ namespace Kimura
 	static const uint32					MaxColorChannels = 2;
 	static const uint32					MaxMipmaps = 8;
 
+	// files written before the table of content was stored as a single block are still supported
+	static const Version				LegacyTOCVersion(0, 5, 0);
+
 
 	class TOCMesh
 	{
@@ -233,8 +254,406 @@ namespace Kimura
 			// info on each single frame present in the document
 			std::vector<TOCFrame>			Frames;
 
+			// known even when only the metadata was read
+			uint32							NumFrames = 0;
+
+	};
+
+
+	/*
+		Table of content layout, from version 0.6:
+
+			Version
+			uint32		Flags (TOCFlags)
+			uint64		MetadataSize				
+			uint64		PageDirectorySize
+			uint64		FrameTablesSize				size of all the pages as stored in the file, compressed or not
+
+			Metadata block								strings, meshes, image sequences, number of frames, frames per page
+			Page directory								TOCPageRecord x NumPages
+			Frame tables, one page after the other. Each page covers FramesPerPage frames (less for the last one) and 
+			holds fixed-stride records, in this order:
+				TOCFrameRecord			x NumFramesInPage
+				TOCFrameMeshRecord		x NumFramesInPage * NumMeshes
+				TOCFrameMeshSection		x NumSections (of the page)
+				TOCFrameImage			x NumFramesInPage * NumImageSequences
+
+			Frame data
+
+		Pages are self-contained so the player only loads the ones covering the frames it buffers.
+	*/
+
+	enum TOCFlags : uint32
+	{
+		TOCFlags_None = 0,
+		TOCFlags_CompressedFrameTables = 1 << 0,		// each page is deflated with zlib
 	};
 
+	static const uint32					TOCHeaderSize = 32;
+
+	class TOCPageRecord
+	{
+		public:
+			uint64	Offset = 0;					// from the start of the frame tables
+			uint32	Size = 0;					// as stored in the file
+			uint32	UncompressedSize = 0;
+			uint32	NumSections = 0;
+			uint32	NotUsed = 0;
+	};
+
+	class TOCFrameRecord
+	{
+		public:
+			uint64	FilePosition = 0;
+			uint32	BufferSize = 0;
+			uint32	FrameIndexDependency = 0;	// first frame needed to resolve this one, resolved by the converter
+	};
+
+	class TOCFrameMeshRecord
+	{
+		public:
+
+			uint32 Vertices = 0;
+			uint32 Surfaces = 0;
+
+			// range in the table of sections
+			uint32 FirstSection = 0;
+			uint32 NumSections = 0;
+
+			int32 SeekIndices = 0;
+			uint32 SizeIndices = 0;
+
+			int32 SeekPositions = 0;
+			uint32 SizePositions = 0;
+			Kimura::Vector3		PositionQuantizationCenter;
+			Kimura::Vector3		PositionQuantizationExtents;
+
+			int32 SeekNormals = 0;
+			uint32 SizeNormals = 0;
+
+			int32 SeekTangents = 0;
+			uint32 SizeTangents = 0;
+
+			int32 SeekVelocities = 0;
+			uint32 SizeVelocities = 0;
+			Kimura::Vector3		VelocityQuantizationCenter;
+			Kimura::Vector3		VelocityQuantizationExtents;
+
+			int32 SeekTexCoords[MaxTextureCoords] = { 0, 0, 0, 0 };
+			uint32 SizeTexCoords[MaxTextureCoords] = { 0, 0, 0, 0 };
+
+			int32 SeekColors[MaxColorChannels] = { 0, 0 };
+			uint32 SizeColors[MaxColorChannels] = { 0, 0 };
+			Kimura::Vector4		ColorQuantizationExtents[MaxColorChannels];
+
+			Kimura::Vector3		BoundingCenter;
+			Kimura::Vector3		BoundingSize;
+	};
+
+	static_assert(sizeof(TOCPageRecord) == 24, "TOCPageRecord is stored as is in the file");
+	static_assert(sizeof(TOCFrameRecord) == 16, "TOCFrameRecord is stored as is in the file");
+	static_assert(sizeof(TOCFrameMeshRecord) == 208, "TOCFrameMeshRecord is stored as is in the file");
+	static_assert(sizeof(TOCFrameMeshSection) == 20, "TOCFrameMeshSection is stored as is in the file");
+	static_assert(sizeof(TOCFrameImage) == 196, "TOCFrameImage is stored as is in the file");
+
+
+	// reads values from a block of the table of content already in memory
+	class TOCBlockReader
+	{
+		public:
+
+			TOCBlockReader(const byte* InData, uint64 InSize) :
+				Data(InData),
+				Size(InSize)
+			{
+			}
+
+			template<typename T>
+			bool Read(T& Out, uint32 InCount = 1)
+			{
+				uint64 size = sizeof(T) * (uint64)InCount;
+				if (this->Position + size > this->Size)
+				{
+					this->Overflow = true;
+					return false;
+				}
+
+				memcpy((void*)&Out, this->Data + this->Position, (size_t)size);
+				this->Position += size;
+
+				return true;
+			}
+
+			bool Read(std::string& s)
+			{
+				int32 size = 0;
+				if (!this->Read<int32>(size) || size < 0 || this->Position + (uint64)size > this->Size)
+				{
+					this->Overflow = true;
+					return false;
+				}
+
+				s.assign((const char*)this->Data + this->Position, (size_t)size);
+				this->Position += (uint64)size;
+
+				return true;
+			}
+
+			const byte*		Data = nullptr;
+			uint64			Size = 0;
+			uint64			Position = 0;
+
+			bool			Overflow = false;
+	};
+
+	// attributes of a frame mesh that are stored in the frame data
+	enum MeshAttribute : uint32
+	{
+		MeshAttribute_Indices = 0,
+		MeshAttribute_Positions,
+		MeshAttribute_Normals,
+		MeshAttribute_Tangents,
+		MeshAttribute_Velocities,
+		MeshAttribute_TexCoords,
+		MeshAttribute_Colors = MeshAttribute_TexCoords + MaxTextureCoords,
+		MeshAttribute_Count = MeshAttribute_Colors + MaxColorChannels
+	};
+
+	static_assert(MeshAttributeFlags_TexCoords0 == 1 << MeshAttribute_TexCoords && MeshAttributeFlags_Colors1 == 1 << (MeshAttribute_Count - 1), 
+		"MeshAttributeFlags out of sync with MeshAttribute");
+
+
+	/*
+		Frames of the table of content as kept in memory by the player, one array per field. A table covers a 
+		range of consecutive frames: a page of the file, or every frame for files without pages.
+
+		Each frame refers to a range of mesh entries and a range of mipmap entries. Meshes that are empty on a 
+		frame have no entry, sections are stored in one pool shared by all the entries, a seek/size pair is only 
+		kept for the attributes a mesh stores (see MeshAttributeMasks) and only the mipmaps a frame uses are kept.
+	*/
+	class TOCFrameTable
+	{
+		public:
+
+			void Initialize(const TableOfContent& InTOC, uint32 InFirstFrame = 0);
+
+			// frames must be added in order, each followed by its meshes and images
+			void AddFrame(uint64 InFilePosition, uint64 InBufferSize);
+			template<typename T>
+			void AddFrameMesh(uint32 InMeshIndex, const T& InFrameMesh, const TOCFrameMeshSection* InSections, uint32 InNumSections);
+			void AddFrameImage(const TOCFrameImage& InFrameImage);
+			void Finalize();
+
+			// walks the frames in order to find the frames each of them depends on
+			void ResolveFrameDependencies(const TableOfContent& InTOC);
+
+			inline uint32 GetNumFrames() const
+			{
+				return (uint32)this->FilePositions.size();
+			}
+
+			// the helpers take frame indices of the whole playback, the per frame arrays are indexed from FirstFrame
+
+			inline uint32 GetFrameIndexDependency(uint32 iFrame) const
+			{
+				return this->FrameIndexDependencies[iFrame - this->FirstFrame];
+			}
+
+			inline bool DependsOnPreviousFrames(uint32 iFrame) const
+			{
+				return this->GetFrameIndexDependency(iFrame) < iFrame;
+			}
+
+			// seek and size of every attribute of a mesh entry. 0 for the attributes the mesh doesn't store
+			void GetAttributes(uint32 InEntry, int32* OutSeeks, uint32* OutSizes) const;
+
+			uint64 GetMemoryUsage() const;
+
+			uint32								FirstFrame = 0;
+
+			// per frame
+			std::vector<uint64>					FilePositions;
+			std::vector<uint32>					BufferSizes;
+			std::vector<uint32>					FrameIndexDependencies;		// first frame needed to resolve the frame, itself when it doesn't depend on others
+			std::vector<uint32>					FirstMeshEntries;			// NumFrames + 1
+			std::vector<uint32>					FirstMipmapEntries;			// NumFrames + 1
+
+			// per mesh entry
+			std::vector<uint32>					MeshIndices;
+			std::vector<uint32>					Vertices;
+			std::vector<uint32>					Surfaces;
+			std::vector<uint32>					FirstSections;
+			std::vector<uint32>					NumSections;
+			std::vector<uint32>					FirstAttributes;
+			std::vector<Kimura::Vector3>		PositionQuantizationCenters;
+			std::vector<Kimura::Vector3>		PositionQuantizationExtents;
+			std::vector<Kimura::Vector3>		VelocityQuantizationCenters;
+			std::vector<Kimura::Vector3>		VelocityQuantizationExtents;
+			std::vector<Kimura::Vector4>		ColorQuantizationExtents;	// MaxColorChannels per entry
+			std::vector<Kimura::Vector3>		BoundingCenters;
+			std::vector<Kimura::Vector3>		BoundingSizes;
+
+			// pools shared by the mesh entries
+			std::vector<TOCFrameMeshSection>	Sections;
+			std::vector<int32>					AttributeSeeks;
+			std::vector<uint32>					AttributeSizes;
+
+			// per image sequence of each frame
+			std::vector<uint8>					NumMipmaps;
+
+			// per mipmap entry
+			std::vector<int32>					MipmapSeeks;
+			std::vector<uint32>					MipmapSizes;
+
+			// per mesh of the document, one bit per MeshAttribute stored
+			std::vector<uint32>					MeshAttributeMasks;
+	};
+
+
+	//-----------------------------------------------------------------------------
+	// TOCFrameTable::AddFrameMesh
+	//-----------------------------------------------------------------------------
+	template<typename T>
+	void TOCFrameTable::AddFrameMesh(uint32 InMeshIndex, const T& InFrameMesh, const TOCFrameMeshSection* InSections, uint32 InNumSections)
+	{
+		// nothing to resolve on empty meshes
+		if (InFrameMesh.Vertices == 0 && InFrameMesh.Surfaces == 0)
+		{
+			return;
+		}
+
+		this->MeshIndices.push_back(InMeshIndex);
+		this->Vertices.push_back(InFrameMesh.Vertices);
+		this->Surfaces.push_back(InFrameMesh.Surfaces);
+
+		this->FirstSections.push_back((uint32)this->Sections.size());
+		this->NumSections.push_back(InNumSections);
+		this->Sections.insert(this->Sections.end(), InSections, InSections + InNumSections);
+
+		this->PositionQuantizationCenters.push_back(InFrameMesh.PositionQuantizationCenter);
+		this->PositionQuantizationExtents.push_back(InFrameMesh.PositionQuantizationExtents);
+		this->VelocityQuantizationCenters.push_back(InFrameMesh.VelocityQuantizationCenter);
+		this->VelocityQuantizationExtents.push_back(InFrameMesh.VelocityQuantizationExtents);
+		this->ColorQuantizationExtents.insert(this->ColorQuantizationExtents.end(), InFrameMesh.ColorQuantizationExtents, InFrameMesh.ColorQuantizationExtents + MaxColorChannels);
+		this->BoundingCenters.push_back(InFrameMesh.BoundingCenter);
+		this->BoundingSizes.push_back(InFrameMesh.BoundingSize);
+
+		int32 seeks[MeshAttribute_Count];
+		uint32 sizes[MeshAttribute_Count];
+
+		seeks[MeshAttribute_Indices] = InFrameMesh.SeekIndices;
+		sizes[MeshAttribute_Indices] = InFrameMesh.SizeIndices;
+		seeks[MeshAttribute_Positions] = InFrameMesh.SeekPositions;
+		sizes[MeshAttribute_Positions] = InFrameMesh.SizePositions;
+		seeks[MeshAttribute_Normals] = InFrameMesh.SeekNormals;
+		sizes[MeshAttribute_Normals] = InFrameMesh.SizeNormals;
+		seeks[MeshAttribute_Tangents] = InFrameMesh.SeekTangents;
+		sizes[MeshAttribute_Tangents] = InFrameMesh.SizeTangents;
+		seeks[MeshAttribute_Velocities] = InFrameMesh.SeekVelocities;
+		sizes[MeshAttribute_Velocities] = InFrameMesh.SizeVelocities;
+
+		for (uint32 iTexCoord = 0; iTexCoord < MaxTextureCoords; iTexCoord++)
+		{
+			seeks[MeshAttribute_TexCoords + iTexCoord] = InFrameMesh.SeekTexCoords[iTexCoord];
+			sizes[MeshAttribute_TexCoords + iTexCoord] = InFrameMesh.SizeTexCoords[iTexCoord];
+		}
+
+		for (uint32 iColor = 0; iColor < MaxColorChannels; iColor++)
+		{
+			seeks[MeshAttribute_Colors + iColor] = InFrameMesh.SeekColors[iColor];
+			sizes[MeshAttribute_Colors + iColor] = InFrameMesh.SizeColors[iColor];
+		}
+
+		this->FirstAttributes.push_back((uint32)this->AttributeSeeks.size());
+
+		uint32 mask = this->MeshAttributeMasks[InMeshIndex];
+		for (uint32 iAttribute = 0; iAttribute < MeshAttribute_Count; iAttribute++)
+		{
+			if (mask & (1 << iAttribute))
+			{
+				this->AttributeSeeks.push_back(seeks[iAttribute]);
+				this->AttributeSizes.push_back(sizes[iAttribute]);
+			}
+		}
+	}
+
+
+	// part of a frame's data read into the frame's buffer, when only some meshes and attributes are loaded
+	struct FrameDataRange
+	{
+		uint32 Offset = 0;			// in the frame's data, as seeked by the table of content
+		uint32 Size = 0;
+		uint32 BufferOffset = 0;	// in the frame's buffer
+		bool Image = false;			// mipmaps, never merged with mesh data
+	};
+
+	// gaps between the ranges of data needed up to this size are read along, rather than splitting the read
+	static const uint32					MaxSkippedFrameDataGap = 16 * 1024;
+
+	// ranges are laid out in the frame's buffer with the alignment they have in the frame's data, up to this
+	static const uint32					FrameDataRangeAlignment = 16;
+
+	// the meshes, attributes and mipmaps whose data is loaded (PlayerOptions::MeshesToLoad, AttributesToLoad, 
+	// MinimumImageMipmaps and LowPriorityImages). Players loading everything along with the meshes have none.
+	class FrameDataSelection
+	{
+		public:
+
+			// nullptr when everything is selected
+			static std::shared_ptr<const FrameDataSelection> Create(const std::vector<bool>& InMeshes, uint32 InAttributes, 
+				const std::vector<uint32>& InMinimumMipmaps, bool InDeferImages);
+
+			// the whole selection, or only what affects the meshes
+			static bool Same(const std::shared_ptr<const FrameDataSelection>& InA, const std::shared_ptr<const FrameDataSelection>& InB);
+			static bool SameMeshData(const std::shared_ptr<const FrameDataSelection>& InA, const std::shared_ptr<const FrameDataSelection>& InB);
+
+			// what's selected by a player without selection
+			static const FrameDataSelection& Get(const std::shared_ptr<const FrameDataSelection>& InSelection);
+
+			// the data a frame seeked to reuses, held or passed along by one of the frames it depends on. Per mesh the 
+			// attributes, per image sequence the mipmaps (a bit each).
+			static std::shared_ptr<const FrameDataSelection> CreateReused(const std::shared_ptr<const FrameDataSelection>& InSelection,
+				const std::vector<uint32>& InAttributes, const std::vector<uint32>& InMipmaps);
+
+			inline bool Includes(uint32 InMeshIndex, uint32 InAttribute) const
+			{
+				return	(this->Attributes & (1u << InAttribute)) != 0 &&
+						(this->Meshes.empty() || (InMeshIndex < this->Meshes.size() && this->Meshes[InMeshIndex])) &&
+						(!this->ReusedDataOnly || (InMeshIndex < this->ReusedAttributes.size() && (this->ReusedAttributes[InMeshIndex] & (1u << InAttribute)) != 0));
+			}
+
+			inline uint32 GetMinimumMipmap(uint32 InImageSequence, uint32 InNumMipmaps) const
+			{
+				uint32 minimum = InImageSequence < this->MinimumMipmaps.size() ? this->MinimumMipmaps[InImageSequence] : 0;
+				return InNumMipmaps > 0 ? std::min(minimum, InNumMipmaps - 1) : 0;
+			}
+
+			inline bool IncludesMipmap(uint32 InImageSequence, uint32 InMipmap, uint32 InNumMipmaps) const
+			{
+				return	InMipmap >= this->GetMinimumMipmap(InImageSequence, InNumMipmaps) &&
+						(!this->ReusedDataOnly || (InImageSequence < this->ReusedMipmaps.size() && (this->ReusedMipmaps[InImageSequence] & (1u << InMipmap)) != 0));
+			}
+
+			// the data of a frame needed by the selection, images included, in order. Ranges close to each other are merged.
+			void GatherRanges(const TOCFrameTable& InTable, uint32 iFrame, std::vector<FrameDataRange>& OutRanges) const;
+
+			std::vector<bool>	Meshes;
+			uint32				Attributes = MeshAttributeFlags_All;
+			std::vector<uint32>	MinimumMipmaps;
+			bool				DeferImages = false;
+
+			bool				ReusedDataOnly = false;
+			std::vector<uint32>	ReusedAttributes;
+			std::vector<uint32>	ReusedMipmaps;
+	};
+
+	class Frame;
+
+	// a reused attribute up to this size is copied into the frame reusing it once the frame holding it is this many 
+	// frames back, instead of keeping that frame's whole buffer alive
+	static const uint32					MaxForwardedAttributeSize = 64 * 1024;
+	static const uint32					ForwardedAttributeFrameDistance = 4;
+
 	class FrameMesh
 	{
 		public:
@@ -289,6 +708,13 @@ namespace Kimura
 			const uint8*			ColorsU8[MaxColorChannels] = { nullptr, nullptr };
 			Vector4					ColorQuantizationExtents[MaxColorChannels];
 
+			// frame whose data holds each attribute, along with the attribute's size
+			const Frame*			AttributeOwners[MeshAttribute_Count] = {};
+			uint32					AttributeSizes[MeshAttribute_Count] = {};
+
+			// whichever of the attribute's pointers is used by the mesh's format
+			const byte*				GetAttributeData(uint32 InAttribute) const;
+			void					SetAttributeData(uint32 InAttribute, const byte* InData);
 
 	};
 
@@ -296,6 +722,8 @@ namespace Kimura
 	{
 		const void* Data = nullptr;
 		uint32 Size;
+
+		const Frame* Owner = nullptr;
 	};
 
 	class FrameImage
@@ -307,6 +735,238 @@ namespace Kimura
 	};
 
 
+	class MappedFile
+	{
+		public:
+
+			~MappedFile();
+
+			bool Open(const std::string& InPath);
+
+			// a byte source already in memory, nothing is mapped
+			bool Open(std::shared_ptr<IByteSource> InSource);
+
+			// make sure the pages covering the specified range are resident in memory
+			void Touch(uint64 InOffset, uint64 InSize);
+
+			const byte*		Data = nullptr;
+			uint64			Size = 0;
+
+		protected:
+
+			std::shared_ptr<IByteSource>	Source;
+
+#if defined(KIMURA_UNREAL)
+			class IMappedFileHandle*	UEMappedHandle = nullptr;
+			class IMappedFileRegion*	UEMappedRegion = nullptr;
+#elif defined(KIMURA_WINDOWS)
+			void*						FileHandle = nullptr;
+			void*						MappingHandle = nullptr;
+#else
+			int							FileDescriptor = -1;
+#endif
+	};
+
+
+	class PositionalFile
+	{
+		public:
+
+			~PositionalFile();
+
+			bool Open(const std::string& InPath);
+
+			// read at the specified position without relying on (or affecting) a shared file pointer
+			bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize);
+
+			uint64 GetSize();
+
+		protected:
+
+#if defined(KIMURA_UNREAL)
+			class IFileHandle*			UEFileHandle = nullptr;
+#elif defined(KIMURA_WINDOWS)
+			void*						FileHandle = nullptr;
+#else
+			int							FileDescriptor = -1;
+#endif
+	};
+
+
+	class FileByteSource : public IByteSource
+	{
+		public:
+
+			bool Open(const std::string& InPath);
+
+			virtual uint64	GetSize() override;
+			virtual bool	ReadAt(uint64 InPosition, void* OutData, uint64 InSize) override;
+
+		protected:
+
+			PositionalFile	File;
+			uint64			Size = 0;
+
+#if defined(KIMURA_UNREAL)
+			// the engine's file handles seek before they read
+			std::mutex		ReadMutex;
+#endif
+	};
+
+
+	class MemoryByteSource : public IByteSource
+	{
+		public:
+
+			MemoryByteSource(const void* InData, uint64 InSize, std::shared_ptr<const void> InOwner);
+
+			virtual uint64		GetSize() override;
+			virtual bool		ReadAt(uint64 InPosition, void* OutData, uint64 InSize) override;
+			virtual const void*	GetData() override;
+
+		protected:
+
+			const byte*					Data = nullptr;
+			uint64						Size = 0;
+			std::shared_ptr<const void>	Owner;
+	};
+
+
+	class SubRangeByteSource : public IByteSource
+	{
+		public:
+
+			SubRangeByteSource(std::shared_ptr<IByteSource> InSource, uint64 InOffset, uint64 InSize);
+
+			virtual uint64		GetSize() override;
+			virtual bool		ReadAt(uint64 InPosition, void* OutData, uint64 InSize) override;
+			virtual const void*	GetData() override;
+
+		protected:
+
+			std::shared_ptr<IByteSource>	Source;
+			uint64							Offset = 0;
+			uint64							Size = 0;
+	};
+
+
+	// PlayerOptions::CacheDirectory. One per directory, shared by the sources cached there. Each block is a file of its
+	// own, named after the key of its source and its index. Blocks are written to a temporary file first, and renamed.
+	class DiskCache
+	{
+		public:
+
+			static std::shared_ptr<DiskCache> Get(const std::string& InDirectory, uint64 InMaxSize);
+
+			// full path and modification time of a file
+			static std::string GetFileKey(const std::string& InPath);
+
+			// InSize bytes at InOffset in the block. False when the block isn't cached.
+			bool Read(const std::string& InName, uint64 InOffset, void* OutData, uint64 InSize);
+
+			// a whole block, read from the source
+			void Write(const std::string& InName, const byte* InData, uint64 InSize);
+
+		protected:
+
+			// picks up the blocks cached by earlier processes, the oldest ones first
+			bool Open(const std::string& InDirectory);
+
+			static bool CreateDirectoryTree(const std::string& InDirectory, std::string& OutFullPath);
+			static bool EndsWith(const std::string& InName, const char* InExtension);
+
+			// expects CacheMutex to be locked by the caller
+			void Evict();
+
+			class CachedFile
+			{
+				public:
+
+					std::string							Name;
+					uint64								Size = 0;
+					uint64								ModificationTime = 0;		// in seconds since 1970
+			};
+
+			class CachedBlock
+			{
+				public:
+
+					uint64								Size = 0;
+					std::list<std::string>::iterator	Use;
+			};
+
+			std::string								Directory;
+			uint64									MaxSize = 0;
+
+			std::mutex								CacheMutex;
+			std::map<std::string, CachedBlock>		Blocks;
+			std::list<std::string>					LeastRecentlyUsed;		// least recently used block first
+			uint64									Size = 0;
+
+			// blocks are written to a temporary file first, named after the process so that processes sharing the cache
+			// don't write to the same one. Those left behind by a process gone for good are deleted by Open, after a while.
+			uint32									ProcessId = 0;
+			std::atomic<uint32>						NextTemporaryFile { 0 };
+
+			static const uint64						TemporaryFileMaxAge = 60 * 60;		// in seconds
+	};
+
+
+	class CachedByteSource : public IByteSource
+	{
+		public:
+
+			CachedByteSource(std::shared_ptr<IByteSource> InSource, std::shared_ptr<DiskCache> InCache, const std::string& InKey);
+
+			virtual uint64	GetSize() override;
+			virtual bool	ReadAt(uint64 InPosition, void* OutData, uint64 InSize) override;
+
+			static const uint64		BlockSize = 1024 * 1024;
+
+		protected:
+
+			std::string GetBlockName(uint64 iBlock);
+
+			std::shared_ptr<IByteSource>	Source;
+			std::shared_ptr<DiskCache>		Cache;
+			std::string						KeyHash;
+			uint64							Size = 0;
+	};
+
+
+	class ThrottledByteSource : public IByteSource
+	{
+		public:
+
+			ThrottledByteSource(std::shared_ptr<IByteSource> InSource, const ThrottleSettings& InSettings);
+
+			virtual uint64	GetSize() override;
+			virtual bool	ReadAt(uint64 InPosition, void* OutData, uint64 InSize) override;
+
+			static bool IsThrottling(const ThrottleSettings& InSettings);
+
+			// KIMURA_THROTTLE, false when it isn't set
+			static bool GetEnvironmentSettings(ThrottleSettings& OutSettings);
+
+		protected:
+
+			// between 0 and 1, the same for the same position and stream
+			double GetRandom(uint64 InPosition, uint64 InStream);
+
+			std::shared_ptr<IByteSource>			Source;
+			ThrottleSettings						Settings;
+
+			// the reads transfer one after the other as their latency ends (in the order the threads get there), their 
+			// latencies overlap
+			std::mutex								TransferMutex;
+			std::chrono::steady_clock::time_point	TransfersEnd;
+
+			// the storage reads ahead by blocks, the many small reads of the table of content come out of the last one
+			static const uint64						ReadAheadSize = 128 * 1024;
+			uint64									LastReadAheadBlock = ~0ull;
+	};
+
+
 	class Frame : public IFrame
 	{
 		public:
@@ -353,26 +1013,410 @@ namespace Kimura
 
 			virtual bool			GetImageData(uint32 InImageIndex, uint32 InMipmap, const void** OutData, uint32& OutSize) override;
 
+			// back to a blank frame, keeping what was allocated for meshes and sections
+			void					Reset();
+
+			// frame data read from the file. Comes uninitialized from the player's FramePool
+			byte*					Buffer = nullptr;
+			uint64					BufferSize = 0;
+			uint64					BufferCapacity = 0;
+
+			// when the file is memory mapped, frame data points directly into the mapping and Buffer remains empty
+			std::shared_ptr<MappedFile>	Mapping;
+
+			// start of this frame's data, either in Buffer or in the mapping
+			const byte*				FrameData = nullptr;
+
+			// meshes and attributes loaded, everything when empty
+			std::shared_ptr<const FrameDataSelection>	Selection;
 
-			std::vector<byte>		Buffer;
+			// parts of the frame's data held by Buffer, back to back. Empty when Buffer holds all of it
+			std::vector<FrameDataRange>	DataRanges;
+
+			// where data seeked by the table of content lies from FrameData
+			uint32					GetBufferOffset(uint32 InSeek) const;
+
+			// PlayerOptions::LowPriorityImages: the image ranges are left out of the frame's read, the images are read and
+			// resolved after the frame is handed out. Until then the frame keeps its page and the frame it follows.
+			std::atomic<bool>		ImagesPending { false };
+			std::mutex				ImagesMutex;
+			std::shared_ptr<Frame>	ImagesPreviousFrame;
+			std::vector<std::shared_ptr<Frame>>	ImageDependencies;		// like FrameDependencies, for reused mipmaps
+
+			// page of the table of content describing this frame, released once the frame is resolved
+			std::shared_ptr<const TOCFrameTable>	TOCPage;
 
 			std::vector<FrameMesh>	Meshes;
 			std::vector<FrameImage>	Images;
 
-			// whenever a frame is dependent on a previous frame, we keep a reference to it 
-			// to keep it alive
+			// small attributes copied from frames far behind, so those frames can be released
+			std::vector<byte>		ForwardedData;
+
+			// whenever a frame reuses data of previous frames, we keep a reference to the frames holding 
+			// that data to keep them alive
 			std::vector<std::shared_ptr<Frame>>	FrameDependencies;
 	};
 
 
+	// Frames and frame buffers released by the player are kept here and handed back out for the frames to come, 
+	// sparing an allocation and a zero-fill for each frame loaded. Frames handed to the user keep the pool alive.
+	class FramePool : public std::enable_shared_from_this<FramePool>
+	{
+		public:
+
+			FramePool(const PlayerOptions& InOptions);
+			~FramePool();
+
+			std::shared_ptr<Frame> AcquireFrame();
+
+			// makes sure the frame's buffer can hold InSize bytes. Content is left uninitialized. nullptr if out of memory.
+			byte* PrepareBuffer(Frame& InOutFrame, uint64 InSize);
+
+			// frees the buffers kept for reuse
+			void ReleaseFreeBuffers();
+
+			// as the buffered window grows or shrinks, frames and buffers kept for reuse past the new limit are freed
+			void SetMaxFreeFrames(uint32 InMaxFreeFrames);
+
+			static const uint64 BufferAlignment = 4096;
+			static const uint64 HugePageSize = 2 * 1024 * 1024;
+
+		protected:
+
+			// buffers are allocated with a few sizes per power of 2 so they can be reused by frames of similar sizes
+			uint64 GetCapacity(uint64 InSize) const;
+
+			void ReleaseFrame(Frame* InFrame);
+			void ReleaseBuffer(byte* InData, uint64 InCapacity);
+
+			byte* Allocate(uint64 InCapacity);
+			void Free(byte* InData, uint64 InCapacity);
+
+			std::shared_ptr<IFrameAllocator>	Allocator;
+			bool								HugePages = false;
+
+			// the frames released at once never outnumber the buffered window, after a jump in the playback
+			uint32								MaxFreeFrames = 0;
+
+			std::mutex							PoolMutex;
+			std::vector<Frame*>					FreeFrames;
+			std::multimap<uint64, byte*>		FreeBuffers;		// by capacity
+	};
+
+
+
+	class FrameRead
+	{
+		public:
+
+			std::shared_ptr<Frame>	Frame_;
+
+			// reads issued before a jump in the playback are discarded
+			uint32					Generation = 0;
+
+			bool					Completed = false;
+
+			// frame already resolved by another cursor of the clip, nothing to read
+			bool					Shared = false;
+
+			// backtracked to, only read and resolved for the frames after it
+			bool					Dependency = false;
+	};
+
+
+	class FrameReader
+	{
+		public:
+
+			virtual ~FrameReader() {}
+
+			// reads complete in any order, they're handed back to the player through Player::CompleteFrameRead
+			virtual void Queue(std::shared_ptr<FrameRead> InRead) = 0;
+	};
+
+
+	class FrameReaderPool : public FrameReader
+	{
+		public:
+
+			FrameReaderPool(class Player* InOwner, uint32 InNumThreads);
+			virtual ~FrameReaderPool();
+
+			virtual void Queue(std::shared_ptr<FrameRead> InRead) override;
+
+		protected:
+
+			void ThreadExecute();
+
+			class Player*							Owner = nullptr;
+
+			std::vector<std::thread*>				Threads;
+
+			std::mutex								QueueMutex;
+			std::condition_variable					QueueEvent;
+			std::deque<std::shared_ptr<FrameRead>>	Reads;
+			bool									StopThreadExecution = false;
+	};
+
+
+	// hands the reads over to the host, which completes them through Player::CompleteExternalRead
+	class ExternalFrameReader : public FrameReader
+	{
+		public:
+
+			ExternalFrameReader(class Player* InOwner);
+
+			virtual void Queue(std::shared_ptr<FrameRead> InRead) override;
+
+			void TakeReads(std::vector<ExternalRead>& OutReads);
+			void CompleteRead(uint64 InReadId, bool InSucceeded);
+
+		protected:
+
+			struct TakenRead
+			{
+				std::shared_ptr<FrameRead>				Read;
+				uint64									Size = 0;
+				std::chrono::steady_clock::time_point	TakeTime;
+			};
+
+			class Player*							Owner = nullptr;
+
+			std::mutex								ReadsMutex;
+			std::deque<std::shared_ptr<FrameRead>>	QueuedReads;
+			std::map<uint64, TakenRead>				TakenReads;
+			uint64									NextReadId = 1;
+	};
+
+
+#if defined(KIMURA_IO_URING)
+
+	class AsyncFrameReader : public FrameReader
+	{
+		public:
+
+			AsyncFrameReader(class Player* InOwner, uint32 InQueueDepth);
+			virtual ~AsyncFrameReader();
+
+			// fails when io_uring isn't available on this system
+			bool Open(const std::string& InPath);
+
+			virtual void Queue(std::shared_ptr<FrameRead> InRead) override;
+
+		protected:
+
+			class AsyncRead
+			{
+				public:
+
+					std::shared_ptr<FrameRead>	Read;
+
+					byte*						Data = nullptr;
+					uint64						Position = 0;
+					uint64						Remaining = 0;
+
+					std::chrono::steady_clock::time_point	SubmitTime;
+			};
+
+			void ThreadExecute();
+
+			// expects SubmitMutex to be locked by the caller
+			void StartRead(uint32 InSlot, std::shared_ptr<FrameRead> InRead);
+			void SubmitRead(uint32 InSlot);
+			void Submit(uint8 InOpcode, uint64 InUserData, uint64 InPosition, byte* InData, uint32 InSize);
+
+			class Player*							Owner = nullptr;
+			uint32									QueueDepth = 0;
+
+			int										FileDescriptor = -1;
+			int										RingFileDescriptor = -1;
+
+			// shared with the kernel
+			void*									SubmissionRing = nullptr;
+			uint64									SubmissionRingSize = 0;
+			void*									CompletionRing = nullptr;
+			uint64									CompletionRingSize = 0;
+			::io_uring_sqe*						SubmissionEntries = nullptr;
+			uint64									SubmissionEntriesSize = 0;
+
+			uint32*									SubmissionTail = nullptr;
+			uint32*									SubmissionMask = nullptr;
+			uint32*									SubmissionArray = nullptr;
+			uint32*									CompletionHead = nullptr;
+			uint32*									CompletionTail = nullptr;
+			uint32*									CompletionMask = nullptr;
+			::io_uring_cqe*						CompletionEntries = nullptr;
+
+			std::thread*							Thread = nullptr;
+
+			std::mutex								SubmitMutex;
+			std::vector<AsyncRead>					Slots;
+			std::vector<uint32>						FreeSlots;
+			std::deque<std::shared_ptr<FrameRead>>	Backlog;
+
+			// set on destruction, reads in flight are drained before the completion thread is stopped
+			bool									Stopping = false;
+			std::condition_variable					SlotFreedEvent;
+	};
+
+#endif
+
+
+	class FrameRequest
+	{
+		public:
+
+			uint32											FrameIndex = 0;
+			std::function<void(std::shared_ptr<IFrame>)>	Callback;
+
+			// settled by the loading side when the frame is about to be dropped, or skipped by a jump
+			bool											Settled = false;
+			std::shared_ptr<Frame>							Frame_;
+	};
+
+
+	// IPlayer::PinFrames and UnpinFrames, picked up by the loading side. The loop head (PlayerOptions::PinLoopHead) is
+	// pinned apart from the user's pins, a frame stays pinned as long as either holds it.
+	class FramePinRequest
+	{
+		public:
+
+			uint32		FirstFrame;
+			uint32		NumFrames;
+			bool		Pinned;
+			bool		LoopHead;
+	};
+
+
+	// Process-wide, started with the first player created with PlayerOptions::SharedScheduler. Those players don't get 
+	// a thread of their own, a few workers shared by all of them buffer a frame at a time for the player whose buffered 
+	// frames run out first. Higher priorities go first.
+	class Scheduler
+	{
+		public:
+
+			static Scheduler& Get();
+
+			~Scheduler();
+
+			// only ever adds workers
+			void SetNumThreads(uint32 InNumThreads);
+
+			void Register(class Player* InPlayer);
+
+			// waits for the worker buffering for this player, if any. No worker touches the player afterwards.
+			void Unregister(class Player* InPlayer);
+
+			void WakeUp(class Player* InPlayer);
+
+		protected:
+
+			class ScheduledPlayer
+			{
+				public:
+
+					class Player*	Player_ = nullptr;
+
+					bool			WorkPending = true;
+					bool			Busy = false;
+			};
+
+			void ThreadExecute();
+
+			// expects SchedulerMutex to be locked by the caller
+			ScheduledPlayer* PickNextPlayer();
+			void StartThreads();
+
+			uint32									NumThreads = 2;
+			std::vector<std::thread*>				Threads;
+
+			std::mutex								SchedulerMutex;
+			std::condition_variable					WorkEvent;
+			std::list<ScheduledPlayer>				Players;
+			bool									StopThreadExecution = false;
+	};
+
+
+	// Kimura::SetFrameMemoryBudget. Frame pools charge the buffers they allocate, players over budget ask the others to
+	// release frames. Never touches the players' frames itself: requests are picked up by the loading side of each 
+	// player, like frame requests.
+	class MemoryBudget
+	{
+		public:
+
+			static MemoryBudget& Get();
+
+			void SetLimit(uint64 InBytes);
+			uint64 GetUsage();
+
+			// frame buffers allocated (positive) and freed (negative), from any thread
+			void Charge(int64 InBytes);
+
+			bool IsOverBudget();
+
+			// the process stays within budget with InBytes more
+			bool HasRoomFor(uint64 InBytes);
+
+			// since a player went over budget, until one notices the process is back within budget
+			bool IsShortOfMemory();
+
+			void Register(class Player* InPlayer);
+			void Unregister(class Player* InPlayer);
+
+			// InPlayer has stopped buffering ahead for lack of memory. The frames behind playback are released first, 
+			// then the lowest priority players' frames ahead.
+			void Reclaim(class Player* InPlayer);
+
+			// InPlayer released frames, or noticed the process is back within budget. The players waiting for memory
+			// look again. Once the shortage is over, the players pin their loop head again.
+			void NotifyReleased(class Player* InPlayer);
+
+		protected:
+
+			class BudgetedPlayer
+			{
+				public:
+
+					class Player*	Player_ = nullptr;
+
+					bool			WaitingForMemory = false;
+			};
+
+			std::atomic<uint64>						Limit { 0 };
+			std::atomic<int64>						Usage { 0 };
+
+			std::mutex								BudgetMutex;
+			std::list<BudgetedPlayer>				Players;
+
+			// released by every player once per shortage, before frames ahead are given up
+			bool									BackBuffersReleased = false;
+			std::atomic<bool>						Shortage { false };
+	};
+
+
+	class Clip;
+
+
+	// distance to a frame playback doesn't get to from where it is, without looping
+	static const uint32					FrameOutOfReach = 0xffffffff;
+
+	// weight of the latest sample in the moving averages of the read and processing times
+	static const double					MovingAverageWeight = 0.125;
+
 
 	class Player : public IPlayer
 	{
 		public:
 
 			Player(const std::string& InPath, const PlayerOptions& InOptions);
+			Player(const std::string& InPath);
+			Player(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
+			Player(std::shared_ptr<IByteSource> InSource);
+			Player(std::shared_ptr<Clip> InClip);
 			virtual ~Player();
 
+			bool Probe(PlaybackInformation& OutInfo);
+
 			virtual PlayerStatus GetStatus() override;
 
 			virtual void GetFailStatusMessage(std::string& OutMessage) override;
@@ -385,6 +1429,21 @@ namespace Kimura
 			virtual int GetBufferedFrameCount() override;
 			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, bool InForceWait) override;
 			virtual std::shared_ptr<IFrame>	GetConstantFrame() override;
+			virtual std::shared_ptr<IFrame>	GetLatestFrame() override;
+
+			virtual void	RequestFrame(uint32 iFrame, std::function<void(std::shared_ptr<IFrame>)> InCallback) override;
+			virtual std::future<std::shared_ptr<IFrame>>	RequestFrame(uint32 iFrame) override;
+
+			virtual bool	Pump(double InTimeBudgetInMS) override;
+
+			virtual void	TakeExternalReads(std::vector<ExternalRead>& OutReads) override;
+			virtual void	CompleteExternalRead(uint64 InReadId, bool InSucceeded) override;
+
+			virtual void	SetDataToLoad(const std::vector<bool>& InMeshes, uint32 InAttributes) override;
+			virtual void	SetMinimumImageMipmap(uint32 InImageSequence, uint32 InMipmap) override;
+
+			virtual void	PinFrames(uint32 InFirstFrame, uint32 InNumFrames) override;
+			virtual void	UnpinFrames(uint32 InFirstFrame, uint32 InNumFrames) override;
 
 			virtual bool	IsForcing16BitIndices() override;
 
@@ -396,14 +1455,106 @@ namespace Kimura
 
 			void Failure(std::string InErrorMessage);
 
+			void StartLoading();
+
 			void ThreadExecute();
+			bool Initialize();
+			void AcceptFrameRequests(bool InInitialized);
+			void Shutdown();
+
+			// shared scheduler and host pumping
+			bool ExecuteScheduledWork();
+			std::chrono::steady_clock::time_point GetBufferDeadline();
 
 			void Stop(bool InWaitToComplete);
 
-			bool ReadTOC();
+			void WakeUpBufferThread();
+
+			bool OpenInputFile();
+			void CloseInputFile();
+
+			bool ReadTOC(bool InMetadataOnly = false);
+			bool ReadLegacyTOC(bool InMetadataOnly);
+			template<typename TReader>
+			void ReadTOCMetadata(TReader& InReader);
+			bool ReadTOCPage(const byte* InData, uint64 InSize, uint32 InNumSections, TOCFrameTable& OutPage);
+			void AdoptTOC(const Player& InSource);
+
+			std::shared_ptr<const TOCFrameTable> AcquireTOCPage(uint32 iFrame);
+			std::shared_ptr<TOCFrameTable> LoadTOCPage(uint32 iPage);
+			void EvictTOCPages();
 
 			bool BufferNextFrame();
-			void LoadFrameAt(uint32 iFrame);
+			void LoadFrameAt(uint32 iFrame, const std::shared_ptr<const FrameDataSelection>& InSelection);
+
+			// seeking: the frames a frame depends on, each with only the data the frame reuses from it
+			bool SelectReusedData(uint32 iFrame, uint32& OutFirstFrame, std::vector<std::shared_ptr<const FrameDataSelection>>& OutSelections);
+
+			// positions of the playback, the frames in the order they're played (PlayerOptions::Direction)
+			uint32 GetNumPlaybackPositions();
+			uint32 GetFrameAtPosition(uint32 InPosition);
+			uint32 GetDistanceToFrame(uint32 InPosition, uint32 iFrame);
+
+			bool ReadFrameData(Frame& InOutFrame);
+			void ResolveFrame(Frame& InOutFrame);
+			void ResolveFrameImages(Frame& InOutFrame, const std::shared_ptr<Frame>& InPreviousFrame);
+			void RetainAttributeOwners(Frame& InOutFrame, const std::shared_ptr<Frame>& InPreviousFrame);
+			void StoreFrame(uint32 iFrame, std::shared_ptr<Frame> InFrame);
+
+			// lock free side of the buffered frames
+			std::shared_ptr<Frame> FindBufferedFrame(uint32 iFrame);
+			void RecordFrameMiss(uint32 iFrame);
+			void MoveBufferingTo(uint32 iFrame);
+			void ApplyFrameRequest();
+			void ApplyDataSelection();
+			void RequestDataSelection(const FrameDataSelection& InSelection);
+
+			// pinned frames
+			void RequestFramePins(uint32 InFirstFrame, uint32 InNumFrames, bool InPinned);
+			void ApplyFramePins();
+			bool IsFramePinned(uint32 iFrame);
+			bool IsFrameNeeded(uint32 iFrame);
+			bool LoadNextPinnedFrame();
+
+			// low priority images
+			bool LoadNextFrameImages();
+			bool LoadFrameImages(const std::shared_ptr<Frame>& InFrame);
+			void PublishBufferedFrames();
+
+			// frame requests
+			void SettleFrameRequests(uint32 InNewBufferedFramesStart);
+			void CompleteFrameRequests(bool InAbandonPending = false);
+			void NotifyFrameBuffered();
+
+			// frame readers
+			bool QueueNextFrameRead();
+			std::shared_ptr<FrameRead> CreateFrameRead(uint32 iFrame, uint32 InGeneration, const std::shared_ptr<const FrameDataSelection>& InSelection);
+			bool IsFrameReadCurrent(const FrameRead& InRead);
+			byte* PrepareFrameBuffer(Frame& InOutFrame, uint64& OutPosition, uint64& OutSize);
+			void ExecuteFrameRead(std::shared_ptr<FrameRead> InRead);
+			void CompleteFrameRead(std::shared_ptr<FrameRead> InRead);
+			void RecordFrameRead(uint64 InBytesRead, double InDuration);
+			void PublishCompletedReads();
+			bool ResolveRawFrames();
+			uint64 GetRawMemoryUsage(uint32& OutNumFrames);
+
+			// adaptive pre-buffering
+			void UpdatePreBufferingSize();
+
+			// memory budget, returns whether frames can be buffered ahead
+			bool ApplyMemoryBudget();
+			void ReleaseBackBuffer();
+			void ShrinkLookAhead();
+			uint64 GetRetainedMemoryUsage();
+
+			friend class FrameReaderPool;
+			friend class ExternalFrameReader;
+#if defined(KIMURA_IO_URING)
+			friend class AsyncFrameReader;
+#endif
+			friend class Clip;
+			friend class Scheduler;
+			friend class MemoryBudget;
 
 			template<typename T>
 			uint32 Read(T& Out, uint32 InCount = 1);
@@ -419,38 +1570,110 @@ namespace Kimura
 
 			TableOfContent	TOC;
 
-			std::thread*				Thread;
+			std::thread*				Thread = nullptr;
 			std::mutex					ThreadEventMutex;
 			std::condition_variable		WakeUpBufferThreadEvent;
+			bool						BufferThreadWorkPending = false;
+
+			// held while pumped by the host (PlayerOptions::ManualPump)
+			std::mutex					PumpMutex;
 
 			std::mutex					WaitForFrameBufferedMutex;
 			std::condition_variable		WaitForFrameBufferedEvent;
 			bool						StopThreadExecution = false;
 
-#if defined(KIMURA_UNREAL)
-			class IFileHandle*			UEFileHandle = nullptr;
-#elif defined(KIMURA_WINDOWS)
-			int							FileHandle = -1;
-#else
-			std::ifstream				InputFile;
-#endif
+			// everything is read from there, opened from InputFilePath unless the player was given one
+			std::shared_ptr<IByteSource>	DataSource;
+			uint64							ReadPosition = 0;		// of the table of content, read front to back
+
+			// the file is read through the cache or the throttling, never around them (mapping, io_uring)
+			bool							DataSourceWrapsFile = false;
+
+			// frame part of the table of content. Loaded a page at a time as frames get buffered
+			uint32										FramesPerTOCPage = 0;
+			bool										CompressedTOCPages = false;
+			uint64										TOCPagesFilePosition = 0;
+			std::vector<TOCPageRecord>					TOCPageDirectory;
+			std::vector<std::shared_ptr<TOCFrameTable>>	TOCPages;
+			std::mutex									TOCPagesMutex;
+
+			std::shared_ptr<MappedFile>	Mapping;
+
+			std::shared_ptr<FramePool>	Pool;
+
+			// set when this player is one of the cursors of a clip
+			std::shared_ptr<Clip>		Clip_;
+
+			FrameReader*				Reader = nullptr;
+			ExternalFrameReader*		ExternalReader = nullptr;		// created up front, the host can call in at any time
+			uint32						MaxReadsInFlight = 0;
+			FrameReadMethod				ReadMethod = FrameReadMethod::Regular;
 
 			std::mutex								FrameAccessMutex;
 
 			uint64									FrameDataFilePosition = 0;
 
-			/* Frames located between FullyBufferedFramesStart and (FullyBufferedFramesStart + FullyBufferedFramesCount ) are fully loaded */
+			/* Frames located between FullyBufferedFramesStart and (FullyBufferedFramesStart + FullyBufferedFramesCount ) are fully loaded. 
+			   Both are playback positions, which only match the frame indices when playing forward */
 			uint32									FullyBufferedFramesStart = 0;
 			uint32									FullyBufferedFramesCount = 0;
 			std::vector<std::shared_ptr<Frame>>		Frames;
 
+			/* Copy of the buffered window (start in the high bits) published for GetFrameAt, which never locks. The frames
+			   themselves are stored atomically. Only the loading side stores and drops them, picking up RequestedFrame. */
+			std::atomic<uint64>						BufferedFrames { 0 };
+			std::atomic<uint32>						RequestedFrame { 0 };
+			std::shared_ptr<Frame>					LatestFrame;
+
+			/* Meshes and attributes the frames to come are loaded with. Changes are picked up by the loading side, like 
+			   RequestedFrame, every frame buffered so far being dropped */
+			std::shared_ptr<const FrameDataSelection>	Selection;
+			std::shared_ptr<const FrameDataSelection>	RequestedSelection;
+			bool										SelectionChanged = false;
+
+			/* Set by the MemoryBudget, picked up by the loading side */
+			std::atomic<bool>						BackBufferReleaseRequested { false };
+			std::atomic<bool>						LookAheadShrinkRequested { false };
+			std::atomic<bool>						LoopHeadPinRequested { false };		// back within budget
+
+			/* Frames kept in memory wherever playback is. Pins and unpins are picked up by the loading side, like RequestedFrame */
+			std::vector<uint8>						PinnedFrames;		// PinnedByUser and PinnedLoopHead
+			std::vector<FramePinRequest>			PinRequests;
+			FramePinRequest							LoopHeadPins = { 0, 0, false, true };
+			uint64									ReleasedLoopHeadMemory = 0;		// when the budget took it
+
+			static const uint8						PinnedByUser = 1;
+			static const uint8						PinnedLoopHead = 2;
+
+			/* Requests made through RequestFrame, completed as their frame gets buffered. Those made before the table of
+			   content is read are taken in by Initialize */
+			std::mutex								FrameRequestsMutex;
+			std::vector<FrameRequest>				FrameRequests;
+			bool									FrameCountKnown = false;
+
+			/* Reads handed to the reader pool, in playback order. Published once they (and the ones before them) complete, 
+			   past PreBufferingSize frames they wait there until playback makes room for them (RawPreBufferingSize) */
+			std::deque<std::shared_ptr<FrameRead>>	PendingReads;
+			uint32									ReadGeneration = 0;
+			bool									ResolvingReads = false;
+
 			std::shared_ptr<Frame>					FirstFrame = nullptr;
 
+			// playback is assumed to carry on from here, at the file's frame rate, when scheduling reads
+			std::atomic<int64>						LastFrameRequestTime { std::chrono::steady_clock::now().time_since_epoch().count() };
+
 
 			std::mutex								ProfilingMutex;
 
 			PlayerStats		Profiling;
 			PlayerStats		StoredProfiling;
+			uint32			LastStalledFrame = 0xffffffff;		// counted once while playback waits on it
+
+			// moving averages of the reads and of the time taken to resolve a frame, for AdaptivePreBuffering
+			double			AverageReadSize = 0.0;
+			double			AverageReadTime = 0.0;
+			double			AverageProcessingTime = 0.0;
+			std::vector<double>	FrameSizesAhead;		// reused from one update of the pre-buffering size to the next
 			std::chrono::time_point<std::chrono::high_resolution_clock>	NextStatsCollection;
 
 
@@ -458,6 +1681,51 @@ namespace Kimura
 	};
 
 
+	// Holds what the cursors of a clip have in common: the table of content, read once through a player without a 
+	// thread, the frame pool, the mapping and the frames resolved so far. Frames and pages are only referenced weakly, 
+	// they stay alive as long as one of the cursors holds on to them.
+	class Clip : public IClip, public std::enable_shared_from_this<Clip>
+	{
+		public:
+
+			Clip(const std::string& InPath, const PlayerOptions& InOptions);
+			Clip(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
+			virtual ~Clip();
+
+			bool Open();
+
+			virtual PlayerStatus GetStatus() override;
+			virtual void GetFailStatusMessage(std::string& OutMessage) override;
+
+			virtual bool RetrievePlaybackInformation(PlaybackInformation& OutInfo) override;
+
+			virtual std::shared_ptr<IPlayer> CreateCursor() override;
+
+			// called by the cursors, from any thread
+			std::shared_ptr<TOCFrameTable> AcquireTOCPage(uint32 iPage);
+			// only frames loaded with the same meshes and attributes are shared
+			std::shared_ptr<Frame> FindFrame(uint32 iFrame, const std::shared_ptr<const FrameDataSelection>& InSelection);
+
+			// returns the frame to keep: the one passed in, or the same frame resolved by another cursor in the meantime
+			std::shared_ptr<Frame> ShareFrame(const std::shared_ptr<Frame>& InFrame);
+
+		protected:
+
+			friend class Player;
+
+			PlayerOptions	Options;
+
+			Player			Source;
+
+			std::shared_ptr<FramePool>		Pool;
+			std::shared_ptr<MappedFile>		Mapping;
+
+			std::mutex									CacheMutex;
+			std::vector<std::weak_ptr<TOCFrameTable>>	TOCPages;
+			std::vector<std::weak_ptr<Frame>>			Frames;
+	};
+
+
 	class ScopedTime
 	{
 		public:
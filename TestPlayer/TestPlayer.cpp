@@ -6,19 +6,167 @@
 //
 
 #include <iostream>
+#include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <fstream>
 
 using namespace std::chrono_literals;
 
 #include "Kimura.h"
 
+const char* GetReadMethodName(Kimura::FrameReadMethod InReadMethod)
+{
+	switch (InReadMethod)
+	{
+		case Kimura::FrameReadMethod::Regular:	return "regular";
+		case Kimura::FrameReadMethod::Threads:	return "threads";
+		case Kimura::FrameReadMethod::IoUring:	return "io_uring";
+		case Kimura::FrameReadMethod::External:	return "external";
+		case Kimura::FrameReadMethod::Mapped:	return "mapped";
+	}
+
+	return "unknown";
+}
+
+// plays the file once, as fast as possible, and returns the throughput in MB/s along with how the frames were read
+double MeasureThroughput(const std::string& InFile, const Kimura::PlayerOptions& InOptions, Kimura::FrameReadMethod& OutReadMethod)
+{
+	std::shared_ptr<Kimura::IPlayer> player = Kimura::CreatePlayer(InFile, InOptions);
+
+	while (player->GetStatus() == Kimura::PlayerStatus::Initializing)
+	{
+		std::this_thread::sleep_for(1ms);
+	}
+
+	if (player->GetStatus() != Kimura::PlayerStatus::Ready)
+	{
+		return 0.0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (Kimura::uint32 iFrame = 0; iFrame < player->GetNumFrames(); iFrame++)
+	{
+		player->GetFrameAt(iFrame, true);
+	}
+
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+	Kimura::PlayerStats stats;
+	player->CollectStats(stats);
+	OutReadMethod = stats.ReadMethod;
+
+	std::ifstream file(InFile, std::ios::binary | std::ios::ate);
+	double megaBytes = (double)file.tellg() / (1024.0 * 1024.0);
+
+	return megaBytes / duration.count();
+}
+
+// compares the read backends at a few queue depths on the same file
+void Benchmark(const std::string& InFile)
+{
+	std::printf("Reading %s (numbers include the page cache unless it is dropped between runs)\n", InFile.c_str());
+
+	Kimura::PlayerOptions options;
+	options.Loop = false;
+	options.PreBufferingSize = 32;
+
+	// the read method actually used is printed along, the player falls back when an option can't be honored
+	Kimura::FrameReadMethod readMethod = Kimura::FrameReadMethod::Regular;
+
+	double throughput = MeasureThroughput(InFile, options, readMethod);
+	std::printf("  blocking reads             : %8.1f MB/s (%s)\n", throughput, GetReadMethodName(readMethod));
+
+	const Kimura::uint32 queueDepths[] = { 1, 4, 16 };
+
+	for (Kimura::uint32 queueDepth : queueDepths)
+	{
+		Kimura::PlayerOptions readerOptions = options;
+		readerOptions.NumReaderThreads = queueDepth;
+
+		throughput = MeasureThroughput(InFile, readerOptions, readMethod);
+		std::printf("  reader threads,  depth %2d  : %8.1f MB/s (%s)\n", queueDepth, throughput, GetReadMethodName(readMethod));
+	}
+
+	for (Kimura::uint32 queueDepth : queueDepths)
+	{
+		Kimura::PlayerOptions asyncOptions = options;
+		asyncOptions.AsyncReadQueueDepth = queueDepth;
+
+		throughput = MeasureThroughput(InFile, asyncOptions, readMethod);
+		std::printf("  io_uring,        depth %2d  : %8.1f MB/s (%s)\n", queueDepth, throughput, GetReadMethodName(readMethod));
+	}
+}
+
+// plays the file once in real time from the slow storage simulated by KIMURA_THROTTLE, fails when playback stalls
+int CheckForStalls(const std::string& InFile)
+{
+	if (std::getenv("KIMURA_THROTTLE") == nullptr)
+	{
+		std::printf("KIMURA_THROTTLE isn't set, e.g. KIMURA_THROTTLE=bandwidth=50000000,latency=8,jitter=4\n");
+		return -1;
+	}
+
+	Kimura::PlayerOptions options;
+	options.Loop = false;
+
+	std::shared_ptr<Kimura::IPlayer> player = Kimura::CreatePlayer(InFile, options);
+
+	while (player->GetStatus() == Kimura::PlayerStatus::Initializing)
+	{
+		std::this_thread::sleep_for(1ms);
+	}
+
+	if (player->GetStatus() != Kimura::PlayerStatus::Ready)
+	{
+		std::string message;
+		player->GetFailStatusMessage(message);
+		std::printf("Failed to open %s: %s\n", InFile.c_str(), message.c_str());
+		return -1;
+	}
+
+	Kimura::PlaybackInformation info;
+	player->RetrievePlaybackInformation(info);
+
+	std::chrono::duration<double> frameTime(1.0 / (info.FrameRate > 0.0f ? info.FrameRate : 30.0));
+
+	// playback starts once the first frame is there
+	player->GetFrameAt(0, true);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (Kimura::uint32 iFrame = 0; iFrame < player->GetNumFrames(); iFrame++)
+	{
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameTime * iFrame));
+		player->GetFrameAt(iFrame, true);
+	}
+
+	Kimura::PlayerStats stats;
+	player->CollectStats(stats);
+
+	std::printf("%s: %d frames played, %d stalls\n", InFile.c_str(), (int)player->GetNumFrames(), (int)stats.NumStalls);
+
+	return stats.NumStalls > 0 ? 1 : 0;
+}
+
 int main(int argc, char* argv[])
 {
 
+    if (argc == 3 && std::string(argv[2]) == "--benchmark")
+    {
+		Benchmark(argv[1]);
+		return 0;
+    }
+
+    if (argc == 3 && std::string(argv[2]) == "--stall-check")
+    {
+		return CheckForStalls(argv[1]);
+    }
+
     if (argc != 2)
     {
-		std::printf("Requires one argument (name of .k file)\n");
+		std::printf("Requires one argument (name of .k file), optionally followed by --benchmark or --stall-check\n");
         return -1;
     }
 